@@ -0,0 +1,306 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  39 Mesa Street, Suite 108A, San Francisco,
+   CA 94129, USA, for further information.
+*/
+
+
+/* Bit exactness check and timings for the row compositors (gxblendrow.c) */
+#include "std.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gxblendrow.h"
+
+/*
+ * Usage: blendbench [-c]
+ *
+ * Runs every SIMD row compositor against gx_blend_row_8 over all the
+ * row widths up to a few vectors (so every remainder is covered), at
+ * several misalignments, channel counts and alpha values, and then over
+ * every combination of source and backdrop alpha. Any difference in any
+ * byte of the parent buffer, including the padding either side of the
+ * row, is reported and makes the exit status nonzero.
+ *
+ * Then, unless -c is given, times both versions on some common cases.
+ */
+
+#define MAX_CHAN 5
+#define PAD 16
+#define EXHAUSTIVE_WIDTH 65536
+#define TIMING_WIDTH 2048
+
+static const char *const mode_names[] = { "Normal", "Multiply", "Screen" };
+static const int test_alphas[] = { 255, 0, 1, 128, 200, -1 };
+
+typedef struct test_buf_s {
+    byte *tos, *nos, *nos_ref, *nos_init, *alpha_g, *mask;
+    int planestride;
+} test_buf;
+
+static unsigned int seed = 1;
+
+static int
+rnd(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) & 0xff;
+}
+
+/* Alphas are mostly at the extremes in real files. */
+static byte
+rnd_alpha(void)
+{
+    int r = rnd();
+
+    return r < 64 ? 0 : r < 128 ? 255 : rnd();
+}
+
+static int
+buf_alloc(test_buf *b, int width)
+{
+    b->planestride = width + 2 * PAD;
+    b->tos = malloc((MAX_CHAN + 1) * b->planestride);
+    b->nos = malloc((MAX_CHAN + 1) * b->planestride);
+    b->nos_ref = malloc((MAX_CHAN + 1) * b->planestride);
+    b->nos_init = malloc((MAX_CHAN + 1) * b->planestride);
+    b->alpha_g = malloc(b->planestride);
+    b->mask = malloc(b->planestride);
+    return b->tos && b->nos && b->nos_ref && b->nos_init && b->alpha_g && b->mask;
+}
+
+static void
+buf_free(test_buf *b)
+{
+    free(b->tos);
+    free(b->nos);
+    free(b->nos_ref);
+    free(b->nos_init);
+    free(b->alpha_g);
+    free(b->mask);
+}
+
+static void
+buf_fill(test_buf *b, int n_chan, bool exhaustive)
+{
+    int size = (n_chan + 1) * b->planestride;
+    int i;
+
+    for (i = 0; i < size; i++) {
+        b->tos[i] = rnd();
+        b->nos_init[i] = rnd();
+    }
+    for (i = 0; i < b->planestride; i++) {
+        b->tos[n_chan * b->planestride + i] = rnd_alpha();
+        b->nos_init[n_chan * b->planestride + i] = rnd_alpha();
+        b->alpha_g[i] = rnd_alpha();
+        b->mask[i] = rnd_alpha();
+    }
+    if (exhaustive) {
+        /* Every source alpha against every backdrop alpha */
+        for (i = 0; i < EXHAUSTIVE_WIDTH; i++) {
+            b->tos[n_chan * b->planestride + PAD + i] = i & 0xff;
+            b->alpha_g[PAD + i] = i & 0xff;
+            b->nos_init[n_chan * b->planestride + PAD + i] = i >> 8;
+        }
+    }
+}
+
+static void
+row_setup(gx_blend_row_t *row, test_buf *b, byte *nos, int off, int n_chan)
+{
+    row->tos_ptr = b->tos + PAD + off;
+    row->tos_planestride = b->planestride;
+    row->tos_alpha_g_ptr = row->isolated ? NULL : b->alpha_g + PAD + off;
+    row->nos_ptr = nos + PAD + off;
+    row->nos_planestride = b->planestride;
+    if (row->mask_ptr != NULL)
+        row->mask_ptr = b->mask + PAD + off;
+    row->n_chan = n_chan;
+}
+
+#ifdef HAVE_SSE2
+static int
+check_row(gx_blend_row_t *row, test_buf *b, int width, int off, int n_chan)
+{
+    int size = (n_chan + 1) * b->planestride;
+    int i;
+
+    memcpy(b->nos_ref, b->nos_init, size);
+    memcpy(b->nos, b->nos_init, size);
+    row_setup(row, b, b->nos_ref, off, n_chan);
+    gx_blend_row_8(row, 0, width);
+    row_setup(row, b, b->nos, off, n_chan);
+    gx_blend_row_8_sse2(row, width);
+    if (memcmp(b->nos, b->nos_ref, size) == 0)
+        return 0;
+    for (i = 0; b->nos[i] == b->nos_ref[i]; i++)
+        DO_NOTHING;
+    printf("MISMATCH: %s %s%s%s%s, alpha %d, %d colours, width %d, offset %d: "
+           "plane %d x %d is %d, expected %d\n",
+           row->isolated ? "isolated" : "non-isolated", mode_names[row->blend_mode],
+           row->mask_ptr != NULL ? " masked" : "", row->subtractive ? " subtractive" : "",
+           row->clear_copy ? " clear_copy" : "", row->alpha, n_chan, width, off,
+           i / b->planestride, i % b->planestride - PAD - off, b->nos[i], b->nos_ref[i]);
+    return 1;
+}
+
+/* Check every row setting, stopping after the first few failures. */
+static int
+check_all(test_buf *b, test_buf *big, byte *tr_ident, byte *tr_rnd)
+{
+    static const int chans[] = { 1, 3, 4, 5 };
+    gx_blend_row_t row;
+    int isolated, mode, masked, subtractive, clear_copy, a, c, width, off;
+    int cases = 0, failures = 0;
+
+    for (isolated = 1; isolated >= 0; isolated--)
+    for (mode = GX_BLEND_ROW_NORMAL; mode <= GX_BLEND_ROW_SCREEN; mode++)
+    for (masked = 0; masked < 3; masked++)
+    for (subtractive = 0; subtractive < 2; subtractive++)
+    for (clear_copy = 0; clear_copy < 2; clear_copy++)
+    for (a = 0; a < countof(test_alphas); a++) {
+        memset(&row, 0, sizeof(row));
+        row.isolated = isolated;
+        row.blend_mode = (gx_blend_row_mode_t)mode;
+        row.subtractive = subtractive;
+        row.clear_copy = clear_copy;
+        row.mask_tr_fn = masked == 2 ? tr_rnd : tr_ident;
+        for (c = 0; c < countof(chans); c++) {
+            /* Every remainder, several times over, at every alignment */
+            for (width = 0; width <= 40; width++) {
+                for (off = 0; off < 4; off++) {
+                    row.alpha = test_alphas[a] < 0 ? rnd() : test_alphas[a];
+                    row.mask_ptr = masked ? b->mask : NULL;
+                    buf_fill(b, chans[c], false);
+                    failures += check_row(&row, b, width, off, chans[c]);
+                    cases++;
+                    if (failures >= 10)
+                        return failures;
+                }
+            }
+        }
+        row.alpha = test_alphas[a] < 0 ? rnd() : test_alphas[a];
+        row.mask_ptr = masked ? big->mask : NULL;
+        buf_fill(big, 3, true);
+        failures += check_row(&row, big, EXHAUSTIVE_WIDTH, 0, 3);
+        cases++;
+        if (failures >= 10)
+            return failures;
+    }
+    printf("blendbench: %d cases checked, %d mismatches\n", cases, failures);
+    return failures;
+}
+#endif
+
+static double
+time_row(gx_blend_row_t *row, test_buf *b, int width, int n_chan, int reps, bool simd)
+{
+    clock_t t0;
+    int i, j;
+
+    row_setup(row, b, b->nos, 0, n_chan);
+    t0 = clock();
+    for (i = 0; i < reps; i++) {
+        for (j = 0; j <= n_chan; j++)
+            memcpy(b->nos + j * b->planestride + PAD,
+                   b->nos_init + j * b->planestride + PAD, width);
+#ifdef HAVE_SSE2
+        if (simd)
+            gx_blend_row_8_sse2(row, width);
+        else
+#endif
+            gx_blend_row_8(row, 0, width);
+    }
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static void
+time_all(test_buf *b, byte *tr_ident)
+{
+    static const struct {
+        bool isolated;
+        gx_blend_row_mode_t mode;
+        bool masked;
+        byte alpha;
+    } cases[] = {
+        { true, GX_BLEND_ROW_NORMAL, false, 255 },
+        { true, GX_BLEND_ROW_NORMAL, true, 255 },
+        { false, GX_BLEND_ROW_NORMAL, false, 255 },
+        { false, GX_BLEND_ROW_NORMAL, false, 128 },
+        { true, GX_BLEND_ROW_MULTIPLY, false, 255 },
+        { true, GX_BLEND_ROW_SCREEN, false, 255 },
+        { false, GX_BLEND_ROW_MULTIPLY, true, 200 }
+    };
+    const int width = TIMING_WIDTH, reps = 20000;
+    gx_blend_row_t row;
+    int i, n_chan;
+
+    for (n_chan = 3; n_chan <= 4; n_chan++) {
+        buf_fill(b, n_chan, false);
+        for (i = 0; i < countof(cases); i++) {
+            double t_c, t_simd = 0;
+
+            memset(&row, 0, sizeof(row));
+            row.isolated = cases[i].isolated;
+            row.blend_mode = cases[i].mode;
+            row.alpha = cases[i].alpha;
+            row.mask_ptr = cases[i].masked ? b->mask : NULL;
+            row.mask_tr_fn = tr_ident;
+            row.clear_copy = row.isolated && row.mask_ptr != NULL &&
+                             row.blend_mode == GX_BLEND_ROW_NORMAL;
+            t_c = time_row(&row, b, width, n_chan, reps, false);
+#ifdef HAVE_SSE2
+            t_simd = time_row(&row, b, width, n_chan, reps, true);
+#endif
+            printf("%-12s %-8s %-6s alpha %3d, %d colours: scalar %7.1f Mpixel/s",
+                   row.isolated ? "isolated" : "non-isolated", mode_names[row.blend_mode],
+                   row.mask_ptr != NULL ? "masked" : "", row.alpha, n_chan,
+                   width * (double)reps / 1e6 / (t_c > 0 ? t_c : 1e-9));
+            if (t_simd > 0)
+                printf(", sse2 %7.1f Mpixel/s (%.1fx)",
+                       width * (double)reps / 1e6 / t_simd, t_c / t_simd);
+            printf("\n");
+        }
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    test_buf small, timing, big;
+    byte tr_ident[256], tr_rnd[256];
+    int failures = 0;
+    int i;
+
+    if (!buf_alloc(&small, 64) || !buf_alloc(&timing, TIMING_WIDTH) ||
+        !buf_alloc(&big, EXHAUSTIVE_WIDTH)) {
+        fprintf(stderr, "blendbench: out of memory\n");
+        return 2;
+    }
+    for (i = 0; i < 256; i++) {
+        tr_ident[i] = i;
+        tr_rnd[i] = rnd_alpha();
+    }
+#ifdef HAVE_SSE2
+    failures = check_all(&small, &big, tr_ident, tr_rnd);
+#else
+    (void)tr_rnd;
+    printf("blendbench: no SIMD row compositors in this build, nothing to check\n");
+#endif
+    if (failures == 0 && !(argc > 1 && strcmp(argv[1], "-c") == 0))
+        time_all(&timing, tr_ident);
+    buf_free(&small);
+    buf_free(&timing);
+    buf_free(&big);
+    return failures != 0;
+}
@@ -0,0 +1,288 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  39 Mesa Street, Suite 108A, San Francisco,
+   CA 94129, USA, for further information.
+*/
+
+
+/* Bit exactness check and timings for the downscaler box filters (gxdownbox.c) */
+#include "std.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gxdownbox.h"
+
+/*
+ * Usage: downbench [-c]
+ *
+ * Runs every SIMD box filter against the plain C one for every factor,
+ * for 1, 3 and 4 components and for 8 and 16 bit samples, over all the
+ * output widths up to a few vectors (so every remainder is covered) and
+ * either side of the internal chunk sizes, at several misalignments and
+ * row spans. Each width is also run with the last few pixels beyond the
+ * real width, as for a padded awidth. Any difference in the output
+ * (including the bytes either side of it) or in the input rows after
+ * padding is reported and makes the exit status nonzero. A few narrow
+ * lines with many components or very large factors check the fallbacks
+ * for pixels too big for the chunks and sums too big for 16 bits.
+ *
+ * Then, unless -c is given, times both versions on some common cases.
+ */
+
+#define MAX_FACTOR 8
+#define MAX_CHAN 4
+#define MAX_WIDTH 2048
+#define PAD 64
+
+/* Big enough for the widest edge case below */
+#define EDGE_MAX_WIDTH 3
+#define EDGE_IN_SIZE (1537 * (EDGE_MAX_WIDTH * 1537 * 2 + 8) + 2 * PAD)
+
+static const int big_widths[] = {
+    47, 48, 49, 63, 64, 65, 95, 96, 97, 191, 192, 193, 255, 256, 257,
+    383, 384, 385, 767, 768, 769, 1535, 1536, 1537, 2047
+};
+
+/* Either side of a pixel filling the 1536 sum chunk, and of the largest
+ * factor whose sums fit in 16 bits (257). */
+static const struct {
+    int deep, nc, factor;
+} edge_cases[] = {
+    { 0, 192, 8 }, { 0, 193, 8 }, { 0, 1, 257 }, { 0, 1, 258 },
+    { 0, 3, 300 }, { 1, 1, 1536 }, { 1, 1, 1537 }
+};
+
+typedef struct test_buf_s {
+    byte *in_init, *in_c, *in_simd, *out_c, *out_simd;
+    int in_size, out_size;
+} test_buf;
+
+static unsigned int seed = 1;
+
+static int
+rnd(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) & 0xff;
+}
+
+static int
+buf_alloc(test_buf *b)
+{
+    b->in_size = MAX_FACTOR * (MAX_WIDTH * MAX_FACTOR * MAX_CHAN * 2 + 2 * PAD);
+    if (b->in_size < EDGE_IN_SIZE)
+        b->in_size = EDGE_IN_SIZE;
+    b->out_size = MAX_WIDTH * MAX_CHAN * 2 + 2 * PAD;
+    b->in_init = malloc(b->in_size);
+    b->in_c = malloc(b->in_size);
+    b->in_simd = malloc(b->in_size);
+    b->out_c = malloc(b->out_size);
+    b->out_simd = malloc(b->out_size);
+    return b->in_init && b->in_c && b->in_simd && b->out_c && b->out_simd;
+}
+
+static void
+buf_free(test_buf *b)
+{
+    free(b->in_init);
+    free(b->in_c);
+    free(b->in_simd);
+    free(b->out_c);
+    free(b->out_simd);
+}
+
+static void
+buf_fill(test_buf *b, int size)
+{
+    int i, r;
+
+    /* Mostly random, with runs of the extremes as in real pages */
+    for (i = 0; i < size; i++) {
+        r = rnd();
+        b->in_init[i] = r < 32 ? 0 : r < 64 ? 0xff : rnd();
+    }
+}
+
+static void
+run_box(byte *outp, byte *inp, int span, int width, int awidth, int factor,
+        int nc, int deep, bool simd)
+{
+#ifdef HAVE_SSE2
+    if (simd) {
+        if (deep)
+            gx_downscale_box16_sse2(outp, inp, span, width, awidth, factor);
+        else
+            gx_downscale_box8_sse2(outp, inp, span, width, awidth, factor, nc);
+        return;
+    }
+#endif
+    if (deep)
+        gx_downscale_box16_c(outp, inp, span, width, awidth, factor);
+    else
+        gx_downscale_box8_c(outp, inp, span, width, awidth, factor, nc);
+}
+
+#ifdef HAVE_SSE2
+static int
+check_box(test_buf *b, int width, int awidth, int factor, int nc, int deep,
+          int off, int extra)
+{
+    int bpp = nc << deep;
+    int span = awidth * factor * bpp + extra;
+    int in_size = factor * span + 2 * PAD;
+    int i;
+
+    buf_fill(b, in_size);
+    memcpy(b->in_c, b->in_init, in_size);
+    memcpy(b->in_simd, b->in_init, in_size);
+    memset(b->out_c, 0x5a, b->out_size);
+    memset(b->out_simd, 0x5a, b->out_size);
+    run_box(b->out_c + PAD, b->in_c + PAD + off, span, width, awidth,
+            factor, nc, deep, false);
+    run_box(b->out_simd + PAD, b->in_simd + PAD + off, span, width, awidth,
+            factor, nc, deep, true);
+    if (memcmp(b->out_c, b->out_simd, b->out_size) == 0 &&
+        memcmp(b->in_c, b->in_simd, in_size) == 0)
+        return 0;
+    printf("MISMATCH: %d bit, %d colours, factor %d, width %d, awidth %d, offset %d, span %d: ",
+           deep ? 16 : 8, nc, factor, width, awidth, off, span);
+    for (i = 0; i < b->out_size && b->out_c[i] == b->out_simd[i]; i++)
+        DO_NOTHING;
+    if (i < b->out_size)
+        printf("output byte %d is %d, expected %d\n",
+               i - PAD, b->out_simd[i], b->out_c[i]);
+    else
+        printf("input rows differ after padding\n");
+    return 1;
+}
+
+/* Check every setting, stopping after the first few failures. */
+static int
+check_all(test_buf *b)
+{
+    static const int chans[] = { 1, 3, 4 };
+    int deep, factor, c, nc, w, awidth, p, off;
+    int cases = 0, failures = 0;
+
+    for (deep = 0; deep < 2; deep++)
+    for (factor = 1; factor <= MAX_FACTOR; factor++)
+    for (c = 0; c < countof(chans); c++) {
+        nc = chans[c];
+        /* The 16 bit filter is only ever used for a single component */
+        if (deep && nc != 1)
+            continue;
+        for (w = 0; w <= 40 + countof(big_widths); w++) {
+            awidth = w <= 40 ? w : big_widths[w - 41];
+            /* No padding, a little, a lot, and none needed */
+            for (p = 0; p < 4; p++) {
+                static const int pads[] = { 0, 1, 7, -3 };
+                int width = awidth - pads[p];
+
+                if (width < 0)
+                    continue;
+                for (off = 0; off < 4; off++) {
+                    failures += check_box(b, width, awidth, factor, nc, deep,
+                                          off, (off * 5) & 7);
+                    cases++;
+                    if (failures >= 10)
+                        return failures;
+                }
+            }
+        }
+    }
+    for (c = 0; c < countof(edge_cases); c++) {
+        for (awidth = 0; awidth <= EDGE_MAX_WIDTH; awidth++)
+        for (p = 0; p < 2 && p <= awidth; p++)
+        for (off = 0; off < 2; off++) {
+            failures += check_box(b, awidth - p, awidth, edge_cases[c].factor,
+                                  edge_cases[c].nc, edge_cases[c].deep,
+                                  off, (off * 5) & 7);
+            cases++;
+            if (failures >= 10)
+                return failures;
+        }
+    }
+    printf("downbench: %d cases checked, %d mismatches\n", cases, failures);
+    return failures;
+}
+#endif
+
+static double
+time_box(test_buf *b, int awidth, int factor, int nc, int deep, int reps,
+         bool simd)
+{
+    int span = awidth * factor * (nc << deep);
+    clock_t t0;
+    int i;
+
+    t0 = clock();
+    for (i = 0; i < reps; i++)
+        run_box(b->out_c, b->in_c, span, awidth, awidth, factor, nc, deep, simd);
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static void
+time_all(test_buf *b)
+{
+    static const struct {
+        int deep, nc, factor;
+    } cases[] = {
+        { 0, 1, 2 }, { 0, 1, 3 }, { 0, 1, 4 }, { 0, 1, 5 }, { 0, 1, 8 },
+        { 0, 3, 2 }, { 0, 3, 3 }, { 0, 3, 5 },
+        { 0, 4, 2 }, { 0, 4, 4 },
+        { 1, 1, 2 }, { 1, 1, 3 }, { 1, 1, 4 }
+    };
+    const int awidth = 1024;
+    int i;
+
+    buf_fill(b, b->in_size);
+    memcpy(b->in_c, b->in_init, b->in_size);
+    for (i = 0; i < countof(cases); i++) {
+        int reps = 200000 / (cases[i].factor * cases[i].factor * cases[i].nc);
+        double t_c, t_simd = 0;
+
+        t_c = time_box(b, awidth, cases[i].factor, cases[i].nc, cases[i].deep,
+                       reps, false);
+#ifdef HAVE_SSE2
+        t_simd = time_box(b, awidth, cases[i].factor, cases[i].nc, cases[i].deep,
+                          reps, true);
+#endif
+        printf("%2d bit, %d colours, factor %d: c %8.1f Mpixel/s",
+               cases[i].deep ? 16 : 8, cases[i].nc, cases[i].factor,
+               awidth * (double)reps / 1e6 / (t_c > 0 ? t_c : 1e-9));
+        if (t_simd > 0)
+            printf(", sse2 %8.1f Mpixel/s (%.1fx)",
+                   awidth * (double)reps / 1e6 / t_simd, t_c / t_simd);
+        printf("\n");
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    test_buf b;
+    int failures = 0;
+
+    if (!buf_alloc(&b)) {
+        fprintf(stderr, "downbench: out of memory\n");
+        return 2;
+    }
+#ifdef HAVE_SSE2
+    failures = check_all(&b);
+#else
+    printf("downbench: no SIMD box filters in this build, nothing to check\n");
+#endif
+    if (failures == 0 && !(argc > 1 && strcmp(argv[1], "-c") == 0))
+        time_all(&b);
+    buf_free(&b);
+    return failures != 0;
+}
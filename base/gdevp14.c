@@ -70,6 +70,7 @@
 #endif
 #include "assert_.h"
 #include "gxgetbit.h"
+#include "gxstats.h"
 
 #if RAW_DUMP
 unsigned int global_index = 0;
@@ -1600,6 +1601,7 @@ pdf14_pop_transparency_group(gs_gstate *pgs, pdf14_ctx *ctx,
     bool overprint = pdev->overprint;
     gx_color_index drawn_comps = pdev->drawn_comps_stroke | pdev->drawn_comps_fill;
     bool has_matte = false;
+    gx_stats_clock t = 0;
     int code = 0;
 
 #ifdef DEBUG
@@ -1711,6 +1713,7 @@ pdf14_pop_transparency_group(gs_gstate *pgs, pdf14_ctx *ctx,
         goto exit;
     if (maskbuf != NULL && maskbuf->data == NULL && maskbuf->alpha == 255)
         goto exit;
+    gx_stats_begin(ctx->memory, t);
 
 #if RAW_DUMP
     /* Dump the current buffer to see what we have. */
@@ -1782,6 +1785,7 @@ pdf14_pop_transparency_group(gs_gstate *pgs, pdf14_ctx *ctx,
                                 ctx->additive, pblend_procs, has_matte, overprint,
                                 drawn_comps, ctx->memory, dev);
     }
+    gx_stats_end(ctx->memory, gx_stats_pdf14_compose, t);
 exit:
     ctx->stack = nos;
     /* We want to detect the cases where we have luminosity soft masks embedded
@@ -29,6 +29,7 @@
 #include "gstrans.h"
 #include "gxdownscale.h"
 #include "gsbitops.h"
+#include "gxstats.h"
 
 #include "gdevkrnlsclass.h" /* 'standard' built in subclasses, currently First/Last Page and obejct filter */
 
@@ -950,6 +951,7 @@ gdev_prn_output_page_aux(gx_device * pdev, int num_copies, int flush, bool seeka
     gs_devn_params *pdevn_params;
     int outcode = 0, errcode = 0, endcode, closecode = 0;
     int code;
+    gx_stats_clock t;
 
     prn_finish_bg_print(ppdev);		/* finish any previous background printing */
 
@@ -1064,8 +1066,10 @@ gdev_prn_output_page_aux(gx_device * pdev, int num_copies, int flush, bool seeka
                 }
                 /* Here's where we actually let the device's print_page_copies work */
                 /* Print the accumulated page description. */
+                gx_stats_begin(pdev->memory, t);
                 outcode = (*ppdev->printer_procs.print_page_copies)(ppdev, ppdev->file,
                                                           num_copies);
+                gx_stats_end(pdev->memory, gx_stats_print_page, t);
                 gp_fflush(ppdev->file);
                 errcode = (gp_ferror(ppdev->file) ? gs_note_error(gs_error_ioerror) : 0);
                 /* NB: background printing does this differently in its thread */
@@ -1177,9 +1181,12 @@ prn_print_page_in_background(void *data)
     int code, errcode = 0;
     int num_copies = bg_print->num_copies;
     gx_device_printer *ppdev = (gx_device_printer *)bg_print->device;
+    gx_stats_clock t;
 
+    gx_stats_begin(ppdev->memory, t);
     code = (*ppdev->printer_procs.print_page_copies)(ppdev, ppdev->file,
                                                           num_copies);
+    gx_stats_end(ppdev->memory, gx_stats_print_page, t);
     gp_fflush(ppdev->file);
 
     errcode = (gp_ferror(ppdev->file) ? gs_note_error(gs_error_ioerror) : 0);
@@ -31,6 +31,7 @@
 struct gs_globals
 {
 	int non_threadsafe_count;
+	void *char_cache;	/* the shared glyph cache (gxshchar.c), if any */
 };
 
 void gs_globals_init(gs_globals *globals);
@@ -317,6 +317,12 @@ gp_clearerr(gp_file *f) {
         (f->ops.clearerr)(f);
 }
 
+/* Read only mappings of (files opened as) gp_files. gp_fmmap returns NULL
+ * if the file cannot be mapped; callers should fall back to gp_fpread. */
+void *gp_fmmap(gp_file *f, size_t len);
+void gp_fmunmap(void *addr, size_t len);
+void gp_fmmap_prefetch(void *addr, size_t len);
+
 /* fname is always in utf8 format */
 static inline gp_file *
 gp_freopen(const char *fname, const char *mode, gp_file *f) {
@@ -639,6 +645,17 @@ int gp_pread_impl(char *buf, size_t count, gs_offset_t offset, FILE *f);
 
 int gp_pwrite_impl(const char *buf, size_t count, gs_offset_t offset, FILE *f);
 
+/* Map the first len bytes of a FILE read only into memory. Returns NULL
+ * if the platform cannot do this, in which case gp_pread_impl should be
+ * used instead. */
+void *gp_mmap_impl(FILE *f, size_t len);
+
+/* Release a mapping made by gp_mmap_impl. */
+void gp_munmap_impl(void *addr, size_t len);
+
+/* Hint that the given range of a mapping will be read soon. */
+void gp_mmap_prefetch_impl(void *addr, size_t len);
+
 gs_offset_t gp_ftell_impl(FILE *f);
 
 int gp_fseek_impl(FILE *strm, gs_offset_t offset, int origin);
@@ -216,8 +216,11 @@ gp_semaphore_signal(gp_semaphore * sema)
     scode = pthread_mutex_lock(&sem->mutex);
     if (scode != 0)
         return SEM_ERROR_CODE(scode);
-    if (sem->count++ == 0)
-        scode = pthread_cond_signal(&sem->cond);
+    /* Always signal: with several waiters, a waiter woken by an earlier */
+    /* signal may not have decremented the count yet, and only waking on */
+    /* the 0 -> 1 transition would leave the others asleep.               */
+    sem->count++;
+    scode = pthread_cond_signal(&sem->cond);
     scode2 = pthread_mutex_unlock(&sem->mutex);
     if (scode == 0)
         scode = scode2;
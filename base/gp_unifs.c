@@ -32,6 +32,9 @@
 #include "dirent_.h"
 #include "unistd_.h"
 #include <stdlib.h>             /* for mkstemp/mktemp */
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 #if !defined(HAVE_FSEEKO)
 #define ftello ftell
@@ -245,6 +248,36 @@ int gp_pwrite_impl(const char *buf, size_t count, gs_offset_t offset, FILE *f)
 #endif
 }
 
+void *gp_mmap_impl(FILE *f, size_t len)
+{
+#if defined(GS_NO_FILESYSTEM) || !defined(HAVE_MMAP)
+    return NULL;
+#else
+    void *addr = mmap(NULL, len, PROT_READ, MAP_SHARED, fileno(f), 0);
+
+    return addr == MAP_FAILED ? NULL : addr;
+#endif
+}
+
+void gp_munmap_impl(void *addr, size_t len)
+{
+#if !defined(GS_NO_FILESYSTEM) && defined(HAVE_MMAP)
+    if (addr != NULL)
+        munmap(addr, len);
+#endif
+}
+
+void gp_mmap_prefetch_impl(void *addr, size_t len)
+{
+#if !defined(GS_NO_FILESYSTEM) && defined(HAVE_MMAP) && defined(MADV_WILLNEED)
+    /* madvise needs a page aligned start address */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t skew = (size_t)addr & (page - 1);
+
+    madvise((char *)addr - skew, len + skew, MADV_WILLNEED);
+#endif
+}
+
 /* Set a file into binary or text mode. */
 int
 gp_setmode_binary_impl(FILE * pfile, bool mode) /* lgtm [cpp/useless-expression] */
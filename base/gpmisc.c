@@ -714,6 +714,25 @@ char *gp_fgets(char *buffer, size_t n, gp_file *f)
     return buffer;
 }
 
+void *gp_fmmap(gp_file *f, size_t len)
+{
+    FILE *file = gp_get_file(f);
+
+    if (file == NULL || len == 0)
+        return NULL;
+    return gp_mmap_impl(file, len);
+}
+
+void gp_fmunmap(void *addr, size_t len)
+{
+    gp_munmap_impl(addr, len);
+}
+
+void gp_fmmap_prefetch(void *addr, size_t len)
+{
+    gp_mmap_prefetch_impl(addr, len);
+}
+
 gp_file *
 gp_fopen(const gs_memory_t *mem, const char *fname, const char *mode)
 {
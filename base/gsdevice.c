@@ -38,6 +38,7 @@
 #include "gsicc_manage.h"
 #include "gscms.h"
 #include "gxgetbit.h"
+#include "gxstats.h"
 
 /* Include the extern for the device list. */
 extern_gs_lib_device_list();
@@ -182,6 +183,7 @@ gs_output_page(gs_gstate * pgs, int num_copies, int flush)
 {
     gx_device *dev = gs_currentdevice(pgs);
     cmm_dev_profile_t *dev_profile;
+    gx_stats_clock t;
     int code;
 
     /* for devices that hook 'fill_path' in order to pick up gs_gstate */
@@ -204,8 +206,10 @@ gs_output_page(gs_gstate * pgs, int num_copies, int flush)
 
     if (dev->IgnoreNumCopies)
         num_copies = 1;
+    gx_stats_begin(dev->memory, t);
     if ((code = (*dev_proc(dev, output_page)) (dev, num_copies, flush)) < 0)
         return code;
+    gx_stats_page(dev, t);
 
     code = dev_proc(dev, get_profile)(dev, &(dev_profile));
     if (code < 0)
@@ -1431,6 +1435,8 @@ gdev_space_params_cmp(const gdev_space_params sp1,
     return(1);
   if (sp1.band.tile_cache_size != sp2.band.tile_cache_size)
     return(1);
+  if (sp1.band.BandListCompression != sp2.band.BandListCompression)
+    return(1);
   if (sp1.params_are_read_only != sp2.params_are_read_only)
     return(1);
   if (sp1.banding_type != sp2.banding_type)
@@ -26,6 +26,8 @@
 #include "gxfixed.h"
 #include "gsicc_manage.h"
 #include "gdevnup.h"		/* to install N-up subclass device */
+#include "gxstats.h"
+#include "gxshchar.h"
 #include "gp_utf8.h"
 
 extern gx_device_nup gs_nup_device;
@@ -296,6 +298,9 @@ int gx_default_get_param(gx_device *dev, char *Param, void *list)
     if (strcmp(Param, "BandWidth") == 0) {
         return param_write_int(plist, "BandWidth", &dev->space_params.band.BandWidth);
     }
+    if (strcmp(Param, "BandListCompression") == 0) {
+        return param_write_int(plist, "BandListCompression", &dev->space_params.band.BandListCompression);
+    }
     if (strcmp(Param, "BufferSpace") == 0) {
         return param_write_size_t(plist, "BufferSpace", &dev->space_params.BufferSpace);
     }
@@ -558,6 +563,23 @@ int gx_default_get_param(gx_device *dev, char *Param, void *list)
             param_string_from_string(nupcontrol, null_str);
         return param_write_string(plist, "NupControl", &nupcontrol);
     }
+    if (strcmp(Param, "EmitStats") == 0) {
+        gs_param_string emitstats;
+        const char *fname = gx_stats_file_name(dev->memory);
+
+        param_string_from_transient_string(emitstats, fname ? fname : null_str);
+        return param_write_string(plist, "EmitStats", &emitstats);
+    }
+    if (strcmp(Param, "SharedGlyphCache") == 0) {
+        size_t sgc = gx_shared_char_cache_size(dev->memory);
+
+        return param_write_size_t(plist, "SharedGlyphCache", &sgc);
+    }
+    if (strcmp(Param, "PatternTileCache") == 0) {
+        size_t ptc = dev->memory->gs_lib_ctx->core->pattern_tile_cache;
+
+        return param_write_size_t(plist, "PatternTileCache", &ptc);
+    }
     if (strcmp(Param, "PageList") == 0){
         gs_param_string pagelist;
         if (dev->PageList) {
@@ -594,7 +616,7 @@ gx_default_get_params(gx_device * dev, gs_param_list * plist)
 
     bool seprs = false;
     gs_param_string dns, pcms, profile_array[NUM_DEVICE_PROFILES];
-    gs_param_string blend_profile, postren_profile, pagelist, nuplist;
+    gs_param_string blend_profile, postren_profile, pagelist, nuplist, emitstats;
     gs_param_string proof_profile, link_profile, icc_colorants;
     gsicc_rendering_intents_t profile_intents[NUM_DEVICE_PROFILES];
     gsicc_blackptcomp_t blackptcomps[NUM_DEVICE_PROFILES];
@@ -836,6 +858,7 @@ gx_default_get_params(gx_device * dev, gs_param_list * plist)
         (code = param_write_size_t(plist, "BandBufferSpace", &dev->space_params.band.BandBufferSpace)) < 0 ||
         (code = param_write_int(plist, "BandHeight", &dev->space_params.band.BandHeight)) < 0 ||
         (code = param_write_int(plist, "BandWidth", &dev->space_params.band.BandWidth)) < 0 ||
+        (code = param_write_int(plist, "BandListCompression", &dev->space_params.band.BandListCompression)) < 0 ||
         (code = param_write_size_t(plist, "BufferSpace", &dev->space_params.BufferSpace)) < 0 ||
         (code = param_write_int(plist, "InterpolateControl", &dev->interpolate_control)) < 0
         )
@@ -883,6 +906,26 @@ gx_default_get_params(gx_device * dev, gs_param_list * plist)
     if ((code = param_write_string(plist, "PageList", &pagelist)) < 0)
         return code;
 
+    {
+        const char *fname = gx_stats_file_name(dev->memory);
+
+        param_string_from_transient_string(emitstats, fname ? fname : null_str);
+        if ((code = param_write_string(plist, "EmitStats", &emitstats)) < 0)
+            return code;
+    }
+    {
+        size_t sgc = gx_shared_char_cache_size(dev->memory);
+
+        if ((code = param_write_size_t(plist, "SharedGlyphCache", &sgc)) < 0)
+            return code;
+    }
+    {
+        size_t ptc = dev->memory->gs_lib_ctx->core->pattern_tile_cache;
+
+        if ((code = param_write_size_t(plist, "PatternTileCache", &ptc)) < 0)
+            return code;
+    }
+
     temp_bool = dev->ObjectFilter & FILTERIMAGE;
     if ((code = param_write_bool(plist, "FILTERIMAGE", &temp_bool)) < 0)
         return code;
@@ -1675,7 +1718,9 @@ gx_default_put_params(gx_device * dev, gs_param_list * plist)
     int rend_intent[NUM_DEVICE_PROFILES];
     int blackptcomp[NUM_DEVICE_PROFILES];
     int blackpreserve[NUM_DEVICE_PROFILES];
-    gs_param_string cms, pagelist, nuplist;
+    gs_param_string cms, pagelist, nuplist, emitstats;
+    size_t sgc = gx_shared_char_cache_size(dev->memory);
+    size_t ptc = dev->memory->gs_lib_ctx->core->pattern_tile_cache;
     int leadingedge = dev->LeadingEdge;
     int k;
     int color_accuracy;
@@ -2153,6 +2198,12 @@ label:\
         CHECK_PARAM_CASES(band.BandBufferSpace, 0, bbse);
     }
 
+    switch (code = param_read_int(plist, (param_name = "BandListCompression"), &sp.band.BandListCompression)) {
+        CHECK_PARAM_CASES(band.BandListCompression,
+                          sp.band.BandListCompression < BandListCompressDefault ||
+                          sp.band.BandListCompression > BandListCompressFast, blce);
+    }
+
 
     switch (code = param_read_bool(plist, (param_name = ".LockSafetyParams"), &locksafe)) {
         case 0:
@@ -2345,6 +2396,32 @@ label:\
         rc_init_free(dev->PageList, dev->memory->non_gc_memory, 1, rc_free_pages_list);
     }
 
+    switch (code = param_read_string(plist, (param_name = "EmitStats"), &emitstats)) {
+        case 0:
+            /* Like OutputFile, this can't be changed once locked. */
+            if (dev->LockSafetyParams && emitstats.size > 0) {
+                const char *fname = gx_stats_file_name(dev->memory);
+
+                if (fname == NULL || strlen(fname) != emitstats.size ||
+                    memcmp(fname, emitstats.data, emitstats.size) != 0) {
+                    ecode = gs_note_error(gs_error_invalidaccess);
+                    param_signal_error(plist, param_name, ecode);
+                }
+            }
+            break;
+        default:
+            ecode = code;
+            param_signal_error(plist, param_name, ecode);
+        case 1:
+            emitstats.data = 0;
+            emitstats.size = 0;
+            break;
+    }
+    if ((code = param_read_size_t(plist, "SharedGlyphCache", &sgc)) < 0)
+        ecode = code;
+    if ((code = param_read_size_t(plist, "PatternTileCache", &ptc)) < 0)
+        ecode = code;
+
     code = param_read_bool(plist, "FILTERIMAGE", &temp_bool);
     if (code < 0)
         ecode = code;
@@ -2518,6 +2595,17 @@ label:\
             return code;
     }
     gsicc_setcoloraccuracy(dev->memory, color_accuracy);
+    if (emitstats.size > 0) {
+        code = gx_stats_open(dev->memory, (const char *)emitstats.data, emitstats.size);
+        if (code < 0)
+            return code;
+    }
+    if (sgc != gx_shared_char_cache_size(dev->memory)) {
+        code = gx_shared_char_cache_set_size(dev->memory, sgc);
+        if (code < 0)
+            return code;
+    }
+    dev->memory->gs_lib_ctx->core->pattern_tile_cache = ptc;
     code = gx_default_put_graytok(devicegraytok, dev);
     if (code < 0)
         return code;
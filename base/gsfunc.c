@@ -67,6 +67,22 @@ fn_common_free(gs_function_t * pfn, bool free_params, gs_memory_t * mem)
     gs_free_object(mem, pfn, "fn_common_free");
 }
 
+/* Generic evaluate_multiple implementation. */
+int
+fn_common_evaluate_multiple(const gs_function_t * pfn, int count,
+                            const float *in, float *out)
+{
+    int m = pfn->params.m, n = pfn->params.n;
+    int i, code;
+
+    for (i = 0; i < count; ++i, in += m, out += n) {
+        code = gs_function_evaluate(pfn, in, out);
+        if (code < 0)
+            return code;
+    }
+    return 0;
+}
+
 /* Check the values of m, n, Domain, and (if supplied) Range. */
 int
 fn_check_mnDR(const gs_function_params_t * params, int m, int n)
@@ -1453,6 +1453,7 @@ gs_function_Sd_init(gs_function_t ** ppfn,
             (fn_free_params_proc_t) gs_function_Sd_free_params,
             fn_common_free,
             (fn_serialize_proc_t) gs_function_Sd_serialize,
+            fn_common_evaluate_multiple
         }
     };
     int code;
@@ -260,6 +260,7 @@ gs_function_ElIn_init(gs_function_t ** ppfn,
             (fn_free_params_proc_t) gs_function_ElIn_free_params,
             fn_common_free,
             (fn_serialize_proc_t) gs_function_ElIn_serialize,
+            fn_common_evaluate_multiple
         }
     };
     int code;
@@ -544,6 +545,7 @@ gs_function_1ItSg_init(gs_function_t ** ppfn,
             (fn_free_params_proc_t) gs_function_1ItSg_free_params,
             fn_common_free,
             (fn_serialize_proc_t) gs_function_1ItSg_serialize,
+            fn_common_evaluate_multiple
         }
     };
     int n = (params->Range == 0 ? 0 : params->n);
@@ -731,6 +733,7 @@ gs_function_AdOt_init(gs_function_t ** ppfn,
             (fn_free_params_proc_t) gs_function_AdOt_free_params,
             fn_common_free,
             (fn_serialize_proc_t) gs_function_AdOt_serialize,
+            fn_common_evaluate_multiple
         }
     };
     int m = params->m, n = params->n;
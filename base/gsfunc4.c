@@ -29,11 +29,15 @@
 #include "spprint.h"
 #include "stream.h"
 
+
+typedef struct calc_program_s calc_program_t;
+
 typedef struct gs_function_PtCr_s {
     gs_function_head_t head;
     gs_function_PtCr_params_t params;
     /* Define a bogus DataSource for get_function_info. */
     gs_data_source_t data_source;
+    calc_program_t *compiled;	/* 0 if we couldn't compile it, see below */
 } gs_function_PtCr_t;
 
 /* GC descriptor */
@@ -102,9 +106,9 @@ typedef enum {
 
 } gs_PtCr_typed_opcode_t;
 
-/* Evaluate a PostScript Calculator function. */
+/* Interpret a PostScript Calculator function. */
 static int
-fn_PtCr_evaluate(const gs_function_t *pfn_common, const float *in, float *out)
+fn_PtCr_interpret(const gs_function_t *pfn_common, const float *in, float *out)
 {
     const gs_function_PtCr_t *pfn = (const gs_function_PtCr_t *)pfn_common;
     calc_value_t vstack_buf[2 + MAX_VSTACK + 1];
@@ -578,6 +582,1239 @@ fn_PtCr_evaluate(const gs_function_t *pfn_common, const float *in, float *out)
     return 0;
 }
 
+/* ---------------- Compiled evaluation ---------------- */
+
+/*
+ * Nearly all the calculator functions met in practice (tint transforms
+ * above all) do the same thing on every call: the operands of the stack
+ * operators are constants, and the types of the values never depend on
+ * the inputs.  So when a function is created we run its operators once
+ * symbolically, keeping for each stack slot either a known constant or
+ * the register that will hold its value at run time, and generate
+ * straight-line code for whatever is left.  Stack operators and constant
+ * expressions disappear at this point, as does the untaken branch of an
+ * if or ifelse whose condition is known; other ifelses compile both
+ * branches and merge the results with selects, and repeats with a
+ * constant count are unrolled.  Instructions whose results are never used
+ * are then dropped, and registers are reused once their values are dead.
+ *
+ * Anything we can't handle this way (a stack operator whose operand
+ * depends on the inputs, types that differ between the branches of an
+ * ifelse, ...) leaves the function to the interpreter.  The compiled
+ * code uses the same C expressions as the interpreter, so the results are
+ * identical; where the interpreter would signal an error, or an integer
+ * would overflow into a real, the compiled code gives up and the
+ * interpreter does the evaluation instead.
+ *
+ * Finally, a smooth function of one input that is expensive to evaluate
+ * (one that uses exp, sin and so on) is sampled into a table, which we
+ * interpolate for inputs within the Domain.  We only keep the table if it
+ * reproduces the function to within 1/65536 of its range.
+ */
+
+#define CALC_MAX_INSNS 2048	/* instructions, after unrolling */
+#define CALC_MAX_VREGS 8192	/* registers before allocation */
+#define CALC_MAX_REGS 256	/* registers after allocation */
+#define CALC_MAX_NESTING 32	/* if and repeat */
+#define CALC_MAX_WORK 0x10000	/* operators compiled, counting repeats */
+#define CALC_SMALL_INT 0x1000000	/* ints below this convert exactly */
+#define CALC_LUT_SIZE 256	/* intervals in the sampled table */
+#define CALC_LUT_MAX_OUTPUTS 16
+
+typedef union calc_reg_u {
+    int i;			/* also used for Boolean */
+    float f;
+} calc_reg_t;
+
+/*
+ * Each instruction does the same as the typed interpreter opcode of the
+ * same name.  Those from CI_abs_int on may find that they must leave the
+ * evaluation to the interpreter.
+ */
+typedef enum {
+    CI_abs, CI_add, CI_and, CI_bitshift, CI_ceiling, CI_cos, CI_cvi,
+    CI_cvr, CI_exp, CI_floor, CI_ln, CI_log, CI_mul, CI_neg, CI_not,
+    CI_not_bool, CI_or, CI_round, CI_sin, CI_sqrt, CI_sub, CI_truncate,
+    CI_xor,
+    CI_eq, CI_ge, CI_gt, CI_le, CI_lt, CI_ne,
+    CI_eq_int, CI_ge_int, CI_gt_int, CI_le_int, CI_lt_int, CI_ne_int,
+    CI_select,			/* d = (c ? a : b) */
+        /* May fail */
+    CI_abs_int, CI_add_int, CI_atan, CI_div, CI_idiv, CI_mod, CI_mul_int,
+    CI_neg_int, CI_sub_int
+} calc_opcode_t;
+#define CI_MAY_FAIL(op) ((op) >= CI_abs_int)
+
+typedef struct calc_insn_s {
+    ushort op, d, a, b, c;	/* unused operands are the same as a */
+} calc_insn_t;
+typedef struct calc_const_s {
+    ushort reg;
+    calc_reg_t value;
+} calc_const_t;
+typedef struct calc_output_s {
+    ushort reg;
+    ushort is_int;
+} calc_output_t;
+
+/*
+ * A compiled function is a single block, so that the garbage collector
+ * only has to know about one pointer.  The header is followed by the
+ * constants, the instructions and the outputs, and then (if lut_size is
+ * not 0) the table at lut_offset.
+ */
+struct calc_program_s {
+    int num_consts;
+    int num_insns;
+    int lut_size;
+    uint lut_offset;
+    float lut_min, lut_max;
+};
+#define calc_consts(prog) ((calc_const_t *)((prog) + 1))
+#define calc_insns(prog)\
+  ((calc_insn_t *)(calc_consts(prog) + (prog)->num_consts))
+#define calc_outputs(prog)\
+  ((calc_output_t *)(calc_insns(prog) + (prog)->num_insns))
+#define calc_lut(prog) ((float *)((byte *)(prog) + (prog)->lut_offset))
+
+/* Run compiled code: return 0, or 1 if the interpreter must take over. */
+static int
+calc_run(const calc_insn_t *pc, int count, calc_reg_t *r)
+{
+    for (; count > 0; ++pc, --count) {
+        calc_reg_t *d = &r[pc->d];
+        const calc_reg_t *a = &r[pc->a], *b = &r[pc->b];
+
+        switch ((calc_opcode_t)pc->op) {
+        case CI_abs:
+            d->f = fabs(a->f);
+            break;
+        case CI_add:
+            d->f = a->f + b->f;
+            break;
+        case CI_and:
+            d->i = a->i & b->i;
+            break;
+        case CI_bitshift: {
+            int n = b->i, v = a->i;
+
+#define MAX_SHIFT (ARCH_SIZEOF_INT * 8 - 1)
+            if (n < -MAX_SHIFT || n > MAX_SHIFT)
+                v = 0;
+#undef MAX_SHIFT
+            else if (n < 0)
+                v = ((uint)v) >> -n;
+            else
+                v <<= n;
+            d->i = v;
+            break;
+        }
+        case CI_ceiling:
+            d->f = ceil(a->f);
+            break;
+        case CI_cos:
+            d->f = gs_cos_degrees(a->f);
+            break;
+        case CI_cvi: {
+            int int1 = (int)(a->f);
+
+            d->i = int1;
+            break;
+        }
+        case CI_cvr: {
+            double v = (double)a->i;
+
+            d->f = v;
+            break;
+        }
+        case CI_exp:
+            d->f = pow(a->f, b->f);
+            break;
+        case CI_floor:
+            d->f = floor(a->f);
+            break;
+        case CI_ln:
+            d->f = log(a->f);
+            break;
+        case CI_log:
+            d->f = log10(a->f);
+            break;
+        case CI_mul:
+            d->f = a->f * b->f;
+            break;
+        case CI_neg:
+            d->f = -a->f;
+            break;
+        case CI_not:
+            d->i = ~a->i;
+            break;
+        case CI_not_bool:
+            d->i = !a->i;
+            break;
+        case CI_or:
+            d->i = a->i | b->i;
+            break;
+        case CI_round:
+            d->f = floor(a->f + 0.5);
+            break;
+        case CI_sin:
+            d->f = gs_sin_degrees(a->f);
+            break;
+        case CI_sqrt:
+            d->f = sqrt(a->f);
+            break;
+        case CI_sub:
+            d->f = a->f - b->f;
+            break;
+        case CI_truncate:
+            d->f = (a->f < 0 ? ceil(a->f) : floor(a->f));
+            break;
+        case CI_xor:
+            d->i = a->i ^ b->i;
+            break;
+        case CI_eq:
+            d->i = a->f == b->f;
+            break;
+        case CI_ge:
+            d->i = a->f >= b->f;
+            break;
+        case CI_gt:
+            d->i = a->f > b->f;
+            break;
+        case CI_le:
+            d->i = a->f <= b->f;
+            break;
+        case CI_lt:
+            d->i = a->f < b->f;
+            break;
+        case CI_ne:
+            d->i = a->f != b->f;
+            break;
+        case CI_eq_int:
+            d->i = a->i == b->i;
+            break;
+        case CI_ge_int:
+            d->i = a->i >= b->i;
+            break;
+        case CI_gt_int:
+            d->i = a->i > b->i;
+            break;
+        case CI_le_int:
+            d->i = a->i <= b->i;
+            break;
+        case CI_lt_int:
+            d->i = a->i < b->i;
+            break;
+        case CI_ne_int:
+            d->i = a->i != b->i;
+            break;
+        case CI_select:
+            *d = (r[pc->c].i ? *a : *b);
+            break;
+        case CI_abs_int:
+            if (a->i >= 0) {
+                d->i = a->i;
+                break;
+            }
+            /* fall through */
+        case CI_neg_int:
+            if (a->i == min_int)
+                return 1;
+            d->i = -a->i;
+            break;
+        case CI_add_int: {
+            int int1 = a->i, int2 = b->i;
+
+            if ((int1 ^ int2) >= 0 && ((int1 + int2) ^ int1) < 0)
+                return 1;
+            d->i = int1 + int2;
+            break;
+        }
+        case CI_atan: {
+            double result;
+
+            if (gs_atan2_degrees(a->f, b->f, &result) < 0)
+                return 1;
+            d->f = result;
+            break;
+        }
+        case CI_div:
+            if (b->f == 0)
+                return 1;
+            d->f = a->f / b->f;
+            break;
+        case CI_idiv:
+            if (b->i == 0 || (a->i == min_int && b->i == -1))
+                return 1;
+            d->i = a->i / b->i;
+            break;
+        case CI_mod:
+            if (b->i == 0 || (a->i == min_int && b->i == -1))
+                return 1;
+            d->i = a->i % b->i;
+            break;
+        case CI_mul_int: {
+            double prod = (double)a->i * b->i;
+
+            if (prod < min_int || prod > max_int)
+                return 1;
+            d->i = (int)prod;
+            break;
+        }
+        case CI_sub_int: {
+            int int1 = a->i, int2 = b->i;
+
+            /* The interpreter makes a real in this case. */
+            if ((int1 ^ int2) < 0 && ((int1 - int2) ^ int1) >= 0)
+                return 1;
+            d->i = int1 - int2;
+            break;
+        }
+        default:
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Load the constants of a compiled function. */
+static void
+calc_load(const calc_program_t *prog, calc_reg_t *r)
+{
+    const calc_const_t *pk = calc_consts(prog);
+    int i;
+
+    for (i = 0; i < prog->num_consts; ++i, ++pk)
+        r[pk->reg] = pk->value;
+}
+
+/* Evaluate a compiled function whose constants are already loaded. */
+static int
+calc_execute(const calc_program_t *prog, int m, int n, calc_reg_t *r,
+             const float *in, float *out)
+{
+    const calc_output_t *po = calc_outputs(prog);
+    int i;
+
+    for (i = 0; i < m; ++i)
+        r[i].f = in[i];
+    if (calc_run(calc_insns(prog), prog->num_insns, r))
+        return 1;
+    for (i = 0; i < n; ++i, ++po)
+        out[i] = (po->is_int ? (float)r[po->reg].i : r[po->reg].f);
+    return 0;
+}
+
+/* Interpolate in the sampled table. */
+static void
+calc_lookup(const calc_program_t *prog, int n, float x, float *out)
+{
+    const float *lut = calc_lut(prog);
+    double t = ((double)x - prog->lut_min) * prog->lut_size /
+        ((double)prog->lut_max - prog->lut_min);
+    int i = (int)t, j;
+
+    if (i >= prog->lut_size) {
+        memcpy(out, lut + prog->lut_size * n, n * sizeof(float));
+        return;
+    }
+    t -= i;
+    lut += i * n;
+    for (j = 0; j < n; ++j)
+        out[j] = lut[j] + (lut[j + n] - lut[j]) * t;
+}
+
+#define calc_use_lut(prog, x)\
+  ((prog)->lut_size != 0 && (x) >= (prog)->lut_min && (x) <= (prog)->lut_max)
+
+/* A value on the stack during compilation. */
+typedef struct calc_sym_s {
+    byte type;			/* calc_value_type_t, or CVT_NUMBER */
+    byte is_const;
+    ushort reg;			/* if !is_const */
+    calc_reg_t value;		/* if is_const */
+} calc_sym_t;
+/*
+ * A NUMBER is a value that is an int on some paths through the function
+ * and a real on others, as after {pop 0} if.  The int is small enough to
+ * convert exactly, so we hold it as a float, and only allow operations
+ * that give the same result either way.
+ */
+#define CVT_NUMBER (CVT_FLOAT + 1)
+#define calc_is_real(t) ((t) == CVT_FLOAT || (t) == CVT_NUMBER)
+#define calc_is_number(t) ((t) == CVT_INT || calc_is_real(t))
+
+typedef struct calc_compiler_s {
+    gs_memory_t *memory;
+    calc_insn_t *insns;		/* [CALC_MAX_INSNS] */
+    int num_insns;
+    calc_const_t *consts;	/* [CALC_MAX_INSNS] */
+    int num_consts;
+    int num_regs;
+    int nesting;
+    int work;
+    bool smooth;		/* no steps or branches (for sampling) */
+    bool costly;		/* uses transcendental functions */
+} calc_compiler_t;
+
+/* Get the register for a value, allocating one for a constant. */
+static int
+calc_reg(calc_compiler_t *cc, const calc_sym_t *ps)
+{
+    int i;
+
+    if (!ps->is_const)
+        return ps->reg;
+    for (i = 0; i < cc->num_consts; ++i)
+        if (cc->consts[i].value.i == ps->value.i)
+            return cc->consts[i].reg;
+    if (cc->num_consts == CALC_MAX_INSNS || cc->num_regs == CALC_MAX_VREGS)
+        return -1;
+    cc->consts[cc->num_consts].reg = cc->num_regs;
+    cc->consts[cc->num_consts++].value = ps->value;
+    return cc->num_regs++;
+}
+
+/*
+ * Apply an instruction to values on the stack, folding constants.
+ * pr may be the same as any of the operands; pb and pc may be 0.
+ */
+static int
+calc_apply(calc_compiler_t *cc, calc_opcode_t op, int type, calc_sym_t *pr,
+           const calc_sym_t *pa, const calc_sym_t *pb, const calc_sym_t *pc)
+{
+    calc_insn_t insn;
+
+    if (pb == 0)
+        pb = pa;
+    if (pc == 0)
+        pc = pa;
+    insn.op = op;
+    if (pa->is_const && pb->is_const && pc->is_const) {
+        calc_reg_t r[4];
+
+        r[0] = pa->value, r[1] = pb->value, r[2] = pc->value;
+        insn.a = 0, insn.b = 1, insn.c = 2, insn.d = 3;
+        if (calc_run(&insn, 1, r)) {
+            /* Do what the interpreter does when an int overflows. */
+            switch (op) {
+            case CI_abs_int: case CI_neg_int:
+                r[3].f = (double)r[0].i;
+                break;
+            case CI_add_int:
+                r[3].f = (double)r[0].i + r[1].i;
+                break;
+            case CI_mul_int:
+                r[3].f = (double)r[0].i * r[1].i;
+                break;
+            case CI_sub_int:
+                r[3].f = (double)r[0].i - r[1].i;
+                break;
+            default:
+                return -1;
+            }
+            type = CVT_FLOAT;
+        }
+        pr->is_const = true;
+        pr->value = r[3];
+    } else {
+        int a = calc_reg(cc, pa), b = calc_reg(cc, pb), c = calc_reg(cc, pc);
+
+        if (a < 0 || b < 0 || c < 0 || cc->num_insns == CALC_MAX_INSNS ||
+            cc->num_regs == CALC_MAX_VREGS)
+            return -1;
+        insn.a = a, insn.b = b, insn.c = c, insn.d = cc->num_regs++;
+        cc->insns[cc->num_insns++] = insn;
+        pr->is_const = false;
+        pr->reg = insn.d;
+        switch (op) {
+        case CI_atan: case CI_cos: case CI_exp: case CI_ln: case CI_log:
+        case CI_sin: case CI_sqrt:
+            cc->costly = true;
+            /* fall through */
+        case CI_abs: case CI_add: case CI_cvr: case CI_div: case CI_mul:
+        case CI_neg: case CI_sub:
+            break;
+        default:
+            cc->smooth = false;
+        }
+    }
+    pr->type = type;
+    return 0;
+}
+
+/* Convert a number to a real. */
+static int
+calc_to_float(calc_compiler_t *cc, calc_sym_t *ps)
+{
+    if (ps->type == CVT_INT)
+        return calc_apply(cc, CI_cvr, CVT_FLOAT, ps, ps, NULL, NULL);
+    if (!calc_is_real(ps->type))
+        return -1;
+    ps->type = CVT_FLOAT;
+    return 0;
+}
+
+/* Compile a comparison. */
+static int
+calc_compare(calc_compiler_t *cc, calc_opcode_t op, calc_opcode_t op_int,
+             calc_sym_t *pa, calc_sym_t *pb)
+{
+    if (pa->type == CVT_INT && pb->type == CVT_INT)
+        return calc_apply(cc, op_int, CVT_BOOL, pa, pa, pb, NULL);
+    /* Comparing a NUMBER with an int is only safe if both are small. */
+    if ((pa->type == CVT_NUMBER && pb->type == CVT_INT &&
+         !(pb->is_const && any_abs(pb->value.i) < CALC_SMALL_INT)) ||
+        (pb->type == CVT_NUMBER && pa->type == CVT_INT &&
+         !(pa->is_const && any_abs(pa->value.i) < CALC_SMALL_INT)))
+        return -1;
+    if (calc_to_float(cc, pa) < 0 || calc_to_float(cc, pb) < 0)
+        return -1;
+    return calc_apply(cc, op, CVT_BOOL, pa, pa, pb, NULL);
+}
+
+/* Turn a value into a NUMBER for merging, if possible. */
+static int
+calc_to_number(calc_sym_t *ps)
+{
+    if (calc_is_real(ps->type))
+        return 0;
+    if (ps->type != CVT_INT || !ps->is_const ||
+        any_abs(ps->value.i) >= CALC_SMALL_INT)
+        return -1;
+    ps->value.f = (float)ps->value.i;
+    return 0;
+}
+
+/*
+ * Merge the stacks left by the two branches of an ifelse, leaving the
+ * result in the second.
+ */
+static int
+calc_merge(calc_compiler_t *cc, const calc_sym_t *pcond,
+           const calc_sym_t *tstack, int tdepth, calc_sym_t *fstack,
+           int fdepth)
+{
+    int i;
+
+    if (tdepth != fdepth)
+        return -1;
+    for (i = 0; i < tdepth; ++i) {
+        calc_sym_t t = tstack[i];
+        calc_sym_t *pf = &fstack[i];
+        int type = t.type;
+
+        if (t.is_const == pf->is_const && t.type == pf->type &&
+            (t.is_const ? t.value.i == pf->value.i : t.reg == pf->reg))
+            continue;
+        if (t.type != pf->type) {
+            if (calc_to_number(&t) < 0 || calc_to_number(pf) < 0)
+                return -1;
+            type = CVT_NUMBER;
+        }
+        if (calc_apply(cc, CI_select, type, pf, &t, pf, pcond) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*
+ * Skip over a procedure body without compiling it.  Return 1 if it ends
+ * with an else, like calc_compile_ops.
+ */
+static int
+calc_skip_ops(const byte *p, const byte *end)
+{
+    while (p < end)
+        switch (*p++) {
+        case PtCr_byte:
+            ++p;
+            break;
+        case PtCr_int:
+            p += sizeof(int);
+            break;
+        case PtCr_float:
+            p += sizeof(float);
+            break;
+        case PtCr_if: {
+            const byte *body = p + 2;
+            int code;
+
+            p = body + (p[0] << 8) + p[1];
+            if (p > end)
+                return -1;
+            code = calc_skip_ops(body, p);
+            if (code < 0)
+                return code;
+            if (code > 0)
+                p += (p[-2] << 8) + p[-1];
+            break;
+        }
+        case PtCr_else:
+            return (p == end - 2 ? 1 : -1);
+        case PtCr_repeat:
+            p += 3 + (p[0] << 8) + p[1];
+            break;
+        case PtCr_return:
+        case PtCr_repeat_end:
+            return -1;
+        }
+    return (p == end ? 0 : -1);
+}
+
+/* Reverse part of the stack, for roll. */
+static void
+calc_reverse(calc_sym_t *from, calc_sym_t *to)
+{
+    for (; from < --to; ++from) {
+        calc_sym_t t = *from;
+
+        *from = *to;
+        *to = t;
+    }
+}
+
+/*
+ * Compile the operators from p to end, with *pdepth values on the stack.
+ * Return 1 if the operators end with an else (having compiled those
+ * before it), 0 otherwise, or -1 if we can't compile them.
+ */
+static int
+calc_compile_ops(calc_compiler_t *cc, const byte *p, const byte *end,
+                 calc_sym_t *stack, int *pdepth)
+{
+    int depth = *pdepth;
+    int code = 0;
+
+#define NEED(k) if (depth < (k)) return -1
+#define PUSH_CONST(t, m, v)\
+  if (depth == MAX_VSTACK) return -1;\
+  stack[depth].type = t, stack[depth].is_const = true,\
+    stack[depth].value.m = v, ++depth
+
+    while (p < end) {
+        int op = *p++;
+        calc_sym_t *pa = &stack[depth > 1 ? depth - 2 : 0];
+        calc_sym_t *pb = &stack[depth > 0 ? depth - 1 : 0];
+
+        if (++cc->work > CALC_MAX_WORK)
+            return -1;
+        switch (op) {
+
+            /* Arithmetic operators */
+
+        case PtCr_abs:
+        case PtCr_neg:
+            NEED(1);
+            if (pb->type == CVT_INT)
+                code = calc_apply(cc, (op == PtCr_abs ? CI_abs_int : CI_neg_int),
+                                  CVT_INT, pb, pb, NULL, NULL);
+            else if (pb->type == CVT_FLOAT ||
+                     (pb->type == CVT_NUMBER && op == PtCr_abs)) /* -0 */
+                code = calc_apply(cc, (op == PtCr_abs ? CI_abs : CI_neg),
+                                  pb->type, pb, pb, NULL, NULL);
+            else
+                return -1;
+            break;
+        case PtCr_add:
+        case PtCr_mul:
+        case PtCr_sub:
+            NEED(2);
+            if (pa->type == CVT_INT && pb->type == CVT_INT)
+                code = calc_apply(cc, (op == PtCr_add ? CI_add_int :
+                                       op == PtCr_mul ? CI_mul_int : CI_sub_int),
+                                  CVT_INT, pa, pa, pb, NULL);
+            else {
+                /* With a NUMBER, make sure the interpreter uses reals too. */
+                if ((pa->type == CVT_NUMBER && pb->type != CVT_FLOAT) ||
+                    (pb->type == CVT_NUMBER && pa->type != CVT_FLOAT) ||
+                    calc_to_float(cc, pa) < 0 || calc_to_float(cc, pb) < 0)
+                    return -1;
+                code = calc_apply(cc, (op == PtCr_add ? CI_add :
+                                       op == PtCr_mul ? CI_mul : CI_sub),
+                                  CVT_FLOAT, pa, pa, pb, NULL);
+            }
+            --depth;
+            break;
+        case PtCr_and:
+        case PtCr_or:
+        case PtCr_xor:
+            NEED(2);
+            if (pa->type != pb->type ||
+                (pa->type != CVT_INT && pa->type != CVT_BOOL))
+                return -1;
+            code = calc_apply(cc, (op == PtCr_and ? CI_and :
+                                   op == PtCr_or ? CI_or : CI_xor),
+                              pa->type, pa, pa, pb, NULL);
+            --depth;
+            break;
+        case PtCr_atan:
+        case PtCr_div:
+        case PtCr_exp:
+            NEED(2);
+            if (calc_to_float(cc, pa) < 0 || calc_to_float(cc, pb) < 0)
+                return -1;
+            code = calc_apply(cc, (op == PtCr_atan ? CI_atan :
+                                   op == PtCr_div ? CI_div : CI_exp),
+                              CVT_FLOAT, pa, pa, pb, NULL);
+            --depth;
+            break;
+        case PtCr_bitshift:
+        case PtCr_idiv:
+        case PtCr_mod:
+            NEED(2);
+            if (pa->type != CVT_INT || pb->type != CVT_INT)
+                return -1;
+            code = calc_apply(cc, (op == PtCr_bitshift ? CI_bitshift :
+                                   op == PtCr_idiv ? CI_idiv : CI_mod),
+                              CVT_INT, pa, pa, pb, NULL);
+            --depth;
+            break;
+        case PtCr_ceiling:
+        case PtCr_floor:
+        case PtCr_round:
+        case PtCr_truncate:
+            NEED(1);
+            if (pb->type == CVT_INT)
+                break;
+            if (!calc_is_real(pb->type))
+                return -1;
+            code = calc_apply(cc, (op == PtCr_ceiling ? CI_ceiling :
+                                   op == PtCr_floor ? CI_floor :
+                                   op == PtCr_round ? CI_round : CI_truncate),
+                              pb->type, pb, pb, NULL, NULL);
+            break;
+        case PtCr_cos:
+        case PtCr_ln:
+        case PtCr_log:
+        case PtCr_sin:
+        case PtCr_sqrt:
+            NEED(1);
+            if (calc_to_float(cc, pb) < 0)
+                return -1;
+            code = calc_apply(cc, (op == PtCr_cos ? CI_cos :
+                                   op == PtCr_ln ? CI_ln :
+                                   op == PtCr_log ? CI_log :
+                                   op == PtCr_sin ? CI_sin : CI_sqrt),
+                              CVT_FLOAT, pb, pb, NULL, NULL);
+            break;
+        case PtCr_cvi:
+            NEED(1);
+            if (pb->type == CVT_INT)
+                break;
+            if (!calc_is_real(pb->type))
+                return -1;
+            code = calc_apply(cc, CI_cvi, CVT_INT, pb, pb, NULL, NULL);
+            break;
+        case PtCr_cvr:
+            NEED(1);
+            code = calc_to_float(cc, pb);
+            break;
+        case PtCr_not:
+            NEED(1);
+            if (pb->type == CVT_BOOL)
+                code = calc_apply(cc, CI_not_bool, CVT_BOOL, pb, pb, NULL, NULL);
+            else if (pb->type == CVT_INT)
+                code = calc_apply(cc, CI_not, CVT_INT, pb, pb, NULL, NULL);
+            else
+                return -1;
+            break;
+
+            /* Comparison operators */
+
+        case PtCr_eq:
+        case PtCr_ne:
+            NEED(2);
+            if (pa->type == CVT_BOOL && pb->type == CVT_BOOL)
+                code = calc_apply(cc, (op == PtCr_eq ? CI_eq_int : CI_ne_int),
+                                  CVT_BOOL, pa, pa, pb, NULL);
+            else if (calc_is_number(pa->type) && calc_is_number(pb->type))
+                code = (op == PtCr_eq ?
+                        calc_compare(cc, CI_eq, CI_eq_int, pa, pb) :
+                        calc_compare(cc, CI_ne, CI_ne_int, pa, pb));
+            else
+                return -1;
+            --depth;
+            break;
+        case PtCr_ge:
+        case PtCr_gt:
+        case PtCr_le:
+        case PtCr_lt:
+            NEED(2);
+            if (!calc_is_number(pa->type) || !calc_is_number(pb->type))
+                return -1;
+            code = (op == PtCr_ge ? calc_compare(cc, CI_ge, CI_ge_int, pa, pb) :
+                    op == PtCr_gt ? calc_compare(cc, CI_gt, CI_gt_int, pa, pb) :
+                    op == PtCr_le ? calc_compare(cc, CI_le, CI_le_int, pa, pb) :
+                    calc_compare(cc, CI_lt, CI_lt_int, pa, pb));
+            --depth;
+            break;
+
+            /* Stack operators */
+
+        case PtCr_copy: {
+            int n;
+
+            NEED(1);
+            if (pb->type != CVT_INT || !pb->is_const)
+                return -1;
+            n = pb->value.i;
+            --depth;
+            if (n < 0 || n > depth || depth + n > MAX_VSTACK)
+                return -1;
+            memcpy(&stack[depth], &stack[depth - n], n * sizeof(*stack));
+            depth += n;
+            break;
+        }
+        case PtCr_dup:
+            NEED(1);
+            if (depth == MAX_VSTACK)
+                return -1;
+            stack[depth++] = *pb;
+            break;
+        case PtCr_exch: {
+            calc_sym_t t;
+
+            NEED(2);
+            t = *pa, *pa = *pb, *pb = t;
+            break;
+        }
+        case PtCr_index: {
+            int n;
+
+            NEED(1);
+            if (pb->type != CVT_INT || !pb->is_const)
+                return -1;
+            n = pb->value.i;
+            if (n < 0 || n >= depth - 1)
+                return -1;
+            *pb = stack[depth - 2 - n];
+            break;
+        }
+        case PtCr_pop:
+            NEED(1);
+            --depth;
+            break;
+        case PtCr_roll: {
+            int n, j;
+
+            NEED(2);
+            if (pa->type != CVT_INT || !pa->is_const ||
+                pb->type != CVT_INT || !pb->is_const)
+                return -1;
+            n = pa->value.i;
+            j = pb->value.i;
+            depth -= 2;
+            if (n < 0 || n > depth)
+                return -1;
+            if (n > 0 && (j %= n) != 0) {
+                calc_sym_t *base = &stack[depth - n];
+
+                if (j < 0)
+                    j += n;
+                calc_reverse(base, base + n);
+                calc_reverse(base, base + j);
+                calc_reverse(base + j, base + n);
+            }
+            break;
+        }
+
+            /* Constants */
+
+        case PtCr_byte:
+            PUSH_CONST(CVT_INT, i, *p++);
+            break;
+        case PtCr_int: {
+            int i;
+
+            memcpy(&i, p, sizeof(int));
+            p += sizeof(int);
+            PUSH_CONST(CVT_INT, i, i);
+            break;
+        }
+        case PtCr_float: {
+            float f;
+
+            memcpy(&f, p, sizeof(float));
+            p += sizeof(float);
+            PUSH_CONST(CVT_FLOAT, f, f);
+            break;
+        }
+        case PtCr_true:
+            PUSH_CONST(CVT_BOOL, i, true);
+            break;
+        case PtCr_false:
+            PUSH_CONST(CVT_BOOL, i, false);
+            break;
+
+            /* Special */
+
+        case PtCr_if: {
+            const byte *body = p + 2;
+            const byte *body_end = body + (p[0] << 8) + p[1];
+            calc_sym_t cond;
+
+            NEED(1);
+            cond = stack[--depth];
+            if (cond.type != CVT_BOOL || body_end > end ||
+                ++cc->nesting > CALC_MAX_NESTING)
+                return -1;
+            if (cond.is_const) {
+                if (cond.value.i)
+                    code = calc_compile_ops(cc, body, body_end, stack, &depth);
+                else
+                    code = calc_skip_ops(body, body_end);
+                if (code < 0)
+                    return code;
+                p = body_end;
+                if (code > 0) {		/* else */
+                    const byte *else_end = p + (p[-2] << 8) + p[-1];
+
+                    if (else_end > end)
+                        return -1;
+                    if (!cond.value.i &&
+                        calc_compile_ops(cc, p, else_end, stack, &depth) != 0)
+                        return -1;
+                    p = else_end;
+                }
+            } else {
+                /* Compile both branches, and merge them. */
+                calc_sym_t *tstack = (calc_sym_t *)
+                    gs_alloc_bytes(cc->memory, MAX_VSTACK * sizeof(*stack),
+                                   "calc_compile_ops");
+                int tdepth = depth;
+
+                if (tstack == 0)
+                    return -1;
+                memcpy(tstack, stack, depth * sizeof(*stack));
+                code = calc_compile_ops(cc, body, body_end, tstack, &tdepth);
+                p = body_end;
+                if (code > 0) {		/* else */
+                    const byte *else_end = p + (p[-2] << 8) + p[-1];
+
+                    code = (else_end > end ? -1 :
+                            calc_compile_ops(cc, p, else_end, stack, &depth));
+                    if (code > 0)
+                        code = -1;
+                    p = else_end;
+                }
+                if (code >= 0)
+                    code = calc_merge(cc, &cond, tstack, tdepth, stack, depth);
+                gs_free_object(cc->memory, tstack, "calc_compile_ops");
+                if (code < 0)
+                    return code;
+            }
+            --cc->nesting;
+            code = 0;
+            break;
+        }
+        case PtCr_else:
+            if (p != end - 2)
+                return -1;
+            *pdepth = depth;
+            return 1;
+        case PtCr_repeat: {
+            const byte *body = p + 2;
+            const byte *body_end = body + (p[0] << 8) + p[1];
+            int count;
+
+            NEED(1);
+            if (pb->type != CVT_INT || !pb->is_const || body_end >= end ||
+                *body_end != PtCr_repeat_end ||
+                ++cc->nesting > CALC_MAX_NESTING)
+                return -1;
+            count = pb->value.i;
+            if (count > CALC_MAX_WORK)
+                return -1;
+            --depth;
+            for (; count > 0; --count)
+                if (calc_compile_ops(cc, body, body_end, stack, &depth) != 0)
+                    return -1;
+            p = body_end + 1;
+            --cc->nesting;
+            break;
+        }
+        default:		/* return, repeat_end */
+            return -1;
+        }
+        if (code < 0)
+            return code;
+    }
+#undef NEED
+#undef PUSH_CONST
+    *pdepth = depth;
+    return 0;
+}
+
+/*
+ * Sample a compiled function of one input into a table, and keep the
+ * table if linear interpolation in it is accurate enough.
+ */
+static void
+calc_sample(calc_program_t *prog, int n, const float *Range)
+{
+    float *lut = calc_lut(prog);
+    double x0 = prog->lut_min, dx = (double)prog->lut_max - prog->lut_min;
+    float tol[CALC_LUT_MAX_OUTPUTS];
+    float out[CALC_LUT_MAX_OUTPUTS], approx[CALC_LUT_MAX_OUTPUTS];
+    calc_reg_t regs[CALC_MAX_REGS];
+    int i, j, k;
+
+    calc_load(prog, regs);
+    for (i = 0; i <= CALC_LUT_SIZE; ++i) {
+        float x = (i == CALC_LUT_SIZE ? prog->lut_max :
+                   x0 + dx * i / CALC_LUT_SIZE);
+
+        if (calc_execute(prog, 1, n, regs, &x, lut + i * n))
+            return;
+        for (j = 0; j < n; ++j)
+            if (!(fabs(lut[i * n + j]) < 1e30))	/* also NaN */
+                return;
+    }
+    for (j = 0; j < n; ++j) {
+        if (Range)
+            tol[j] = (Range[2 * j + 1] - Range[2 * j]) / 65536;
+        else {
+            float vmin = lut[j], vmax = lut[j];
+
+            for (i = 1; i <= CALC_LUT_SIZE; ++i) {
+                vmin = min(vmin, lut[i * n + j]);
+                vmax = max(vmax, lut[i * n + j]);
+            }
+            tol[j] = (vmax - vmin) / 65536;
+        }
+    }
+    /* Check the table between the samples. */
+    prog->lut_size = CALC_LUT_SIZE;
+    for (i = 0; i < CALC_LUT_SIZE; ++i)
+        for (k = 1; k < 4; ++k) {
+            float x = x0 + dx * (i * 4 + k) / (CALC_LUT_SIZE * 4);
+
+            if (calc_execute(prog, 1, n, regs, &x, out))
+                goto fail;
+            calc_lookup(prog, n, x, approx);
+            for (j = 0; j < n; ++j)
+                if (!(fabs(approx[j] - out[j]) <= tol[j]))
+                    goto fail;
+        }
+    return;
+ fail:
+    prog->lut_size = 0;
+}
+
+/* Working storage for calc_compile. */
+typedef struct calc_work_s {
+    calc_insn_t insns[CALC_MAX_INSNS];
+    calc_const_t consts[CALC_MAX_INSNS];
+    calc_sym_t stack[MAX_VSTACK];
+    calc_output_t outputs[MAX_VSTACK];
+    int last_use[CALC_MAX_VREGS];
+    ushort map[CALC_MAX_VREGS];
+    byte live[CALC_MAX_VREGS];
+} calc_work_t;
+
+/*
+ * Compile a function, setting pfn->compiled if we can.  Failure isn't an
+ * error: it just leaves the function to the interpreter.
+ */
+static void
+calc_compile(gs_function_PtCr_t *pfn, gs_memory_t *mem)
+{
+    int m = pfn->params.m, n = pfn->params.n;
+    const float *Domain = pfn->params.Domain;
+    calc_work_t *work = (calc_work_t *)
+        gs_alloc_bytes(mem, sizeof(calc_work_t), "calc_compile");
+    calc_compiler_t cc;
+    calc_insn_t *pi;
+    calc_program_t *prog;
+    ushort free_regs[CALC_MAX_REGS];
+    int num_free = 0, num_phys, num_insns, num_consts;
+    int depth = m, i, v;
+    uint size, lut_offset = 0;
+    bool use_lut;
+
+    pfn->compiled = 0;
+    if (work == 0)
+        return;
+    cc.memory = mem;
+    cc.insns = work->insns;
+    cc.num_insns = 0;
+    cc.consts = work->consts;
+    cc.num_consts = 0;
+    cc.num_regs = m;
+    cc.nesting = 0;
+    cc.work = 0;
+    cc.smooth = true;
+    cc.costly = false;
+    for (i = 0; i < m; ++i) {
+        work->stack[i].type = CVT_FLOAT;
+        work->stack[i].is_const = false;
+        work->stack[i].reg = i;
+    }
+    if (calc_compile_ops(&cc, pfn->params.ops.data,
+                         pfn->params.ops.data + pfn->params.ops.size - 1,
+                         work->stack, &depth) != 0 || depth < n)
+        goto done;
+    for (i = 0; i < n; ++i) {
+        const calc_sym_t *ps = &work->stack[depth - n + i];
+        int reg = calc_reg(&cc, ps);
+
+        if (ps->type == CVT_BOOL || reg < 0)
+            goto done;
+        work->outputs[i].reg = reg;
+        work->outputs[i].is_int = (ps->type == CVT_INT);
+    }
+
+    /*
+     * Drop the instructions whose results aren't used, except those that
+     * may fail.  Each register is only set once, so we mark the kept
+     * instructions by marking their results as live.
+     */
+    memset(work->live, 0, cc.num_regs);
+    for (i = 0; i < n; ++i)
+        work->live[work->outputs[i].reg] = 1;
+    for (i = cc.num_insns; --i >= 0; ) {
+        pi = &cc.insns[i];
+        if (work->live[pi->d] || CI_MAY_FAIL(pi->op))
+            work->live[pi->d] = work->live[pi->a] = work->live[pi->b] =
+                work->live[pi->c] = 1;
+    }
+    for (i = num_insns = 0; i < cc.num_insns; ++i)
+        if (work->live[cc.insns[i].d])
+            cc.insns[num_insns++] = cc.insns[i];
+
+    /*
+     * Allocate registers: the inputs and constants keep theirs for the
+     * whole evaluation, and the others are reused after their last use.
+     */
+    for (v = 0; v < cc.num_regs; ++v)
+        work->last_use[v] = -1;
+    for (i = 0; i < num_insns; ++i) {
+        pi = &cc.insns[i];
+        work->last_use[pi->a] = work->last_use[pi->b] =
+            work->last_use[pi->c] = i;
+    }
+    for (v = 0; v < m; ++v) {
+        work->map[v] = v;
+        work->last_use[v] = num_insns;
+    }
+    num_phys = m;
+    for (i = num_consts = 0; i < cc.num_consts; ++i) {
+        v = cc.consts[i].reg;
+        if (work->live[v]) {
+            work->map[v] = num_phys;
+            work->last_use[v] = num_insns;
+            cc.consts[num_consts].reg = num_phys++;
+            cc.consts[num_consts++].value = cc.consts[i].value;
+        }
+    }
+    for (i = 0; i < n; ++i)
+        work->last_use[work->outputs[i].reg] = num_insns;
+    if (num_phys > CALC_MAX_REGS)
+        goto done;
+    for (i = 0; i < num_insns; ++i) {
+        int a, b, c, d;
+
+        pi = &cc.insns[i];
+        a = pi->a, b = pi->b, c = pi->c, d = pi->d;
+        pi->a = work->map[a], pi->b = work->map[b], pi->c = work->map[c];
+        if (work->last_use[a] == i)
+            free_regs[num_free++] = work->map[a];
+        if (b != a && work->last_use[b] == i)
+            free_regs[num_free++] = work->map[b];
+        if (c != a && c != b && work->last_use[c] == i)
+            free_regs[num_free++] = work->map[c];
+        if (num_free > 0)
+            pi->d = free_regs[--num_free];
+        else if (num_phys == CALC_MAX_REGS)
+            goto done;
+        else
+            pi->d = num_phys++;
+        work->map[d] = pi->d;
+        if (work->last_use[d] < 0)	/* only kept because it may fail */
+            free_regs[num_free++] = pi->d;
+    }
+    for (i = 0; i < n; ++i)
+        work->outputs[i].reg = work->map[work->outputs[i].reg];
+
+    size = sizeof(calc_program_t) + num_consts * sizeof(calc_const_t) +
+        num_insns * sizeof(calc_insn_t) + n * sizeof(calc_output_t);
+    use_lut = m == 1 && cc.smooth && cc.costly &&
+        n <= CALC_LUT_MAX_OUTPUTS && Domain[0] < Domain[1] &&
+        (double)Domain[1] - Domain[0] < 1e30;
+    if (use_lut) {
+        lut_offset = ROUND_UP(size, sizeof(float));
+        size = lut_offset + (CALC_LUT_SIZE + 1) * n * sizeof(float);
+    }
+    prog = (calc_program_t *)gs_alloc_bytes(mem, size, "calc_compile");
+    if (prog == 0)
+        goto done;
+    prog->num_consts = num_consts;
+    prog->num_insns = num_insns;
+    prog->lut_size = 0;
+    prog->lut_offset = lut_offset;
+    prog->lut_min = Domain[0];
+    prog->lut_max = Domain[1];
+    memcpy(calc_consts(prog), cc.consts, num_consts * sizeof(calc_const_t));
+    memcpy(calc_insns(prog), cc.insns, num_insns * sizeof(calc_insn_t));
+    memcpy(calc_outputs(prog), work->outputs, n * sizeof(calc_output_t));
+    if (use_lut)
+        calc_sample(prog, n, pfn->params.Range);
+    pfn->compiled = prog;
+ done:
+    gs_free_object(mem, work, "calc_compile");
+}
+
+/* Evaluate a PostScript Calculator function. */
+static int
+fn_PtCr_evaluate(const gs_function_t *pfn_common, const float *in, float *out)
+{
+    const gs_function_PtCr_t *pfn = (const gs_function_PtCr_t *)pfn_common;
+    const calc_program_t *prog = pfn->compiled;
+
+    if (prog != 0) {
+        calc_reg_t regs[CALC_MAX_REGS];
+
+        if (calc_use_lut(prog, in[0])) {
+            calc_lookup(prog, pfn->params.n, in[0], out);
+            return 0;
+        }
+        calc_load(prog, regs);
+        if (calc_execute(prog, pfn->params.m, pfn->params.n, regs, in, out) == 0)
+            return 0;
+    }
+    return fn_PtCr_interpret(pfn_common, in, out);
+}
+
+/* Evaluate a PostScript Calculator function at a number of points. */
+static int
+fn_PtCr_evaluate_multiple(const gs_function_t *pfn_common, int count,
+                          const float *in, float *out)
+{
+    const gs_function_PtCr_t *pfn = (const gs_function_PtCr_t *)pfn_common;
+    const calc_program_t *prog = pfn->compiled;
+    int m = pfn->params.m, n = pfn->params.n;
+    calc_reg_t regs[CALC_MAX_REGS];
+    int i, code;
+
+    if (prog != 0)
+        calc_load(prog, regs);
+    for (i = 0; i < count; ++i, in += m, out += n) {
+        if (prog != 0) {
+            if (calc_use_lut(prog, in[0])) {
+                calc_lookup(prog, n, in[0], out);
+                continue;
+            }
+            if (calc_execute(prog, m, n, regs, in, out) == 0)
+                continue;
+        }
+        code = fn_PtCr_interpret(pfn_common, in, out);
+        if (code < 0)
+            return code;
+    }
+    return 0;
+}
+
 /* Test whether a PostScript Calculator function is monotonic. */
 static int
 fn_PtCr_is_monotonic(const gs_function_t * pfn_common,
@@ -794,6 +2031,7 @@ fn_PtCr_make_scaled(const gs_function_PtCr_t *pfn, gs_function_PtCr_t **ppsfn,
     psfn->params.ops.data =
         gs_resize_string(mem, ops, opsize, psfn->params.ops.size,
                          "fn_PtCr_make_scaled");
+    calc_compile(psfn, mem);
     *ppsfn = psfn;
     return 0;
 }
@@ -808,6 +2046,17 @@ gs_function_PtCr_free_params(gs_function_PtCr_params_t * params, gs_memory_t * m
     fn_common_free_params((gs_function_params_t *) params, mem);
 }
 
+/* Free a PostScript Calculator function. */
+static void
+fn_PtCr_free(gs_function_t *pfn_common, bool free_params, gs_memory_t *mem)
+{
+    gs_function_PtCr_t *pfn = (gs_function_PtCr_t *)pfn_common;
+
+    gs_free_object(mem, pfn->compiled, "fn_PtCr_free");
+    pfn->compiled = 0;
+    fn_common_free(pfn_common, free_params, mem);
+}
+
 /* Serialize. */
 static int
 gs_function_PtCr_serialize(const gs_function_t * pfn, stream *s)
@@ -838,8 +2087,9 @@ gs_function_PtCr_init(gs_function_t ** ppfn,
             fn_common_get_params,
             (fn_make_scaled_proc_t) fn_PtCr_make_scaled,
             (fn_free_params_proc_t) gs_function_PtCr_free_params,
-            fn_common_free,
+            fn_PtCr_free,
             (fn_serialize_proc_t) gs_function_PtCr_serialize,
+            fn_PtCr_evaluate_multiple
         }
     };
     int code;
@@ -896,6 +2146,7 @@ gs_function_PtCr_init(gs_function_t ** ppfn,
         data_source_init_string2(&pfn->data_source, NULL, 0);
         pfn->data_source.access = calc_access;
         pfn->head = function_PtCr_head;
+        calc_compile(pfn, mem);
         *ppfn = (gs_function_t *) pfn;
     }
     return 0;
@@ -36,6 +36,7 @@
 #include "gzstate.h"
 #include "stdint_.h"
 #include "assert_.h"
+#include "gxstats.h"
         /*
          *  Note that the the external memory used to maintain
          *  links in the CMS is generally not visible to GS.
@@ -132,6 +133,52 @@ gsicc_cache_new(gs_memory_t *memory)
     return(result);
 }
 
+/**
+ * gsicc_cache_addref: Take a reference to a link cache that may be
+ * shared between threads (e.g. the clist rendering threads and the
+ * background printing thread).
+ * @icc_link_cache: The link cache
+ *
+ * The increment is done with the cache locked, so that it cannot race
+ * with other threads taking or dropping references.
+ *
+ * Return value: The link cache.
+ **/
+gsicc_link_cache_t *
+gsicc_cache_addref(gsicc_link_cache_t *icc_link_cache)
+{
+    gx_monitor_enter(icc_link_cache->lock);
+    rc_increment(icc_link_cache);
+    gx_monitor_leave(icc_link_cache->lock);
+    return icc_link_cache;
+}
+
+/**
+ * gsicc_cache_release: Drop a reference to a link cache taken with
+ * gsicc_cache_addref.
+ * @icc_link_cache: The link cache (may be NULL)
+ * @cname: Client name for debugging
+ *
+ * Other threads may still hold references so the decrement is done with
+ * the cache locked. The final reference is dropped without the lock, as
+ * freeing the cache frees the lock too, but then no one else can be
+ * using it.
+ **/
+void
+gsicc_cache_release(gsicc_link_cache_t *icc_link_cache, client_name_t cname)
+{
+    if (icc_link_cache == NULL)
+        return;
+    gx_monitor_enter(icc_link_cache->lock);
+    if (icc_link_cache->rc.ref_count > 1) {
+        rc_decrement_only(icc_link_cache, cname);
+        gx_monitor_leave(icc_link_cache->lock);
+        return;
+    }
+    gx_monitor_leave(icc_link_cache->lock);
+    rc_decrement(icc_link_cache, cname);
+}
+
 static void
 rc_gsicc_link_cache_free(gs_memory_t * mem, void *ptr_in, client_name_t cname)
 {
@@ -1002,6 +1049,7 @@ gsicc_get_link_profile(const gs_gstate *pgs, gx_device *dev,
     bool src_dev_link = gs_input_profile->isdevlink;
     bool pageneutralcolor = false;
     int cms_flags = 0;
+    gx_stats_clock t;
 
     /* Determine if we are using a soft proof or device link profile */
     if (dev != NULL ) {
@@ -1049,6 +1097,7 @@ gsicc_get_link_profile(const gs_gstate *pgs, gx_device *dev,
                    "[icc] output_numcomps = %d, output_hash = %lld \n",
                    gs_output_profile->num_comps,
                    (long long)gs_output_profile->hashcode);
+        gx_stats_count(memory, gx_stats_icc_cache_hit);
         return found_link;
     }
     /* Before we do anything, check if we have a case where the source profile
@@ -1100,10 +1149,14 @@ gsicc_get_link_profile(const gs_gstate *pgs, gx_device *dev,
        usually return a link that is not yet valid, but may return a valid link
        if another thread has already created it */
     if (gsicc_alloc_link_entry(icc_link_cache, &link, hash, include_softproof,
-                               include_devicelink))
+                               include_devicelink)) {
+        gx_stats_count(memory, gx_stats_icc_cache_hit);
         return link;
+    }
     if (link == NULL)
         return NULL;		/* error, couldn't allocate a link.  Nothing to cleanup */
+    gx_stats_count(memory, gx_stats_icc_cache_miss);
+    gx_stats_begin(memory, t);
 
     /* Here the link was new and the contents have valid=false and we	*/
     /* own the lock for the link_profile. Build the profile, set valid	*/
@@ -1317,6 +1370,7 @@ gsicc_get_link_profile(const gs_gstate *pgs, gx_device *dev,
         gx_monitor_leave(link->lock);
         goto icc_link_error;
     }
+    gx_stats_end(memory, gx_stats_icc_link, t);
     return link;
 
 icc_link_error:
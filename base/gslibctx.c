@@ -54,6 +54,8 @@
 #endif
 #include "gsargs.h"
 #include "globals.h"
+#include "gxstats.h"
+#include "gxshchar.h"
 
 /* Include the extern for the device list. */
 extern_gs_lib_device_list();
@@ -433,6 +435,8 @@ void gs_lib_ctx_fin(gs_memory_t *mem)
     refs = --ctx->core->refs;
     gx_monitor_leave((gx_monitor_t *)(ctx->core->monitor));
     if (refs == 0) {
+        gx_stats_close(mem);
+        gx_shared_char_cache_detach(mem);
         gscms_destroy(ctx->core->cms_context);
         gx_monitor_free((gx_monitor_t *)(ctx->core->monitor));
 #ifdef WITH_CAL
@@ -135,6 +135,12 @@ typedef struct {
 
     void *cms_context;  /* Opaque context pointer from underlying CMS in use */
 
+    void *stats;        /* Opaque pointer to the EmitStats collector (gxstats.c) */
+
+    void *shared_char_cache; /* Opaque pointer to the shared glyph cache (gxshchar.c) */
+
+    size_t pattern_tile_cache; /* Budget for keeping Pattern tiles by content (gxpcmap.c) */
+
     gs_callout_list_t *callouts;
 
     /* Stashed args */
@@ -280,6 +280,37 @@ alpha_buffer_release(gs_gstate * pgs, bool newpath)
     return code;
 }
 
+/*
+ * Decide whether an antialiased fill can be done by computing the pixel
+ * coverage analytically (see gxscanc.c), rather than through an alpha
+ * buffer. We need the edgebuffer scan converter, and a device that can
+ * take 8 bit copy_alpha. Paths with no area go through the alpha buffer,
+ * where the fill adjustment still makes them mark the page.
+ */
+static bool
+coverage_fill_possible(gs_gstate * pgs, bool devn)
+{
+    gx_device *dev = gs_currentdevice_inline(pgs);
+    int scanconverter = gs_getscanconverter(pgs->memory);
+    gs_fixed_rect bbox;
+
+    if (scanconverter < GS_SCANCONVERTER_EDGEBUFFER &&
+        !(scanconverter == GS_SCANCONVERTER_DEFAULT && GS_SCANCONVERTER_DEFAULT_IS_EDGEBUFFER))
+        return false;
+    if (dev_proc(dev, dev_spec_op)(dev, gxdso_copy_alpha_disabled, NULL, 0) == 1)
+        return false;
+    if (devn) {
+        if (dev_proc(dev, copy_alpha_hl_color) == gx_default_no_copy_alpha_hl_color)
+            return false;
+    } else if (dev_proc(dev, copy_alpha) == NULL ||
+               dev_proc(dev, copy_alpha) == gx_no_copy_alpha)
+        return false;
+    if (gx_path_bbox(pgs->path, &bbox) < 0 ||
+        bbox.p.x == bbox.q.x || bbox.p.y == bbox.q.y)
+        return false;
+    return true;
+}
+
 /* Setup for black vector handling */
 static inline bool black_vectors(gs_gstate *pgs, gx_device *dev)
 {
@@ -348,6 +379,18 @@ static int do_fill(gs_gstate *pgs, int rule)
         if (color_is_pure(col) || devn)
             abits = alpha_buffer_bits(pgs);
     }
+    if (abits > 1 && coverage_fill_possible(pgs, devn)) {
+        /* We may have to update the marking parameters if we have a pdf14
+           device as our target, as alpha_buffer_init does. */
+        if (dev_proc(pgs->device, dev_spec_op)(pgs->device, gxdso_is_pdf14_device, NULL, 0) > 0) {
+            code = gs_update_trans_marking_params(pgs);
+            if (code < 0)
+                goto out;
+        }
+        code = gx_fill_path_coverage(pgs->path, gs_currentdevicecolor_inline(pgs),
+                                     pgs, rule);
+        goto out;
+    }
     if (abits > 1) {
         acode = alpha_buffer_init(pgs, pgs->fill_adjust.x,
                                   pgs->fill_adjust.y, abits, devn);
@@ -42,6 +42,7 @@
 #include "gsiparm4.h"
 #include "gsovrc.h"
 #include "gxdevsop.h"
+#include "gxstats.h"
 
 /* Temporary switches for experimanting with Adobe compatibility. */
 #define ADJUST_SCALE_FOR_THIN_LINES 0   /* Old code = 0 */
@@ -119,6 +120,7 @@ gs_pattern1_init(gs_pattern1_template_t * ppat)
     gs_pattern_common_init((gs_pattern_template_t *)ppat, &gs_pattern1_type);
     ppat->uses_transparency = 0;        /* false */
     ppat->BM_Not_Normal = 0;            /* false */
+    ppat->ContentDigest = NULL;
 }
 
 /* Make an instance of a PatternType 1 pattern. */
@@ -1735,8 +1737,10 @@ gx_pattern_cache_lookup(gx_device_color * pdevc, const gs_gstate * pgs,
                 pdevc->mask.m_tile = ctile;
             pdevc->mask.m_phase.x = -px;
             pdevc->mask.m_phase.y = -py;
+            gx_stats_count(pgs->memory, gx_stats_pattern_cache_hit);
             return true;
         }
+        gx_stats_count(pgs->memory, gx_stats_pattern_cache_miss);
     }
     return false;
 }
@@ -42,6 +42,10 @@ typedef struct gs_pattern1_template_s {
     float XStep;
     float YStep;
     int (*PaintProc) (const gs_client_color *, gs_gstate *);
+    /* If not NULL, stores 16 bytes identifying what PaintProc draws */
+    /* (apart from the graphics state) and returns 1, or returns 0 if */
+    /* it can't tell.  See gx_pattern_load. */
+    int (*ContentDigest) (const gs_client_color *, byte *);
 } gs_pattern1_template_t;
 
 #define private_st_pattern1_template() /* in gspcolor.c */\
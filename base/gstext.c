@@ -34,6 +34,7 @@
 #include "gxdevsop.h"
 #include "gscspace.h"
 #include "gsicc_blacktext.h"
+#include "gxstats.h"
 
 /* GC descriptors */
 public_st_gs_text_params();
@@ -676,7 +677,14 @@ gs_text_resync(gs_text_enum_t *pte, const gs_text_enum_t *pfrom)
 int
 gs_text_process(gs_text_enum_t * pte)
 {
-    return pte->procs->process(pte);
+    gs_memory_t *mem = pte->memory;
+    gx_stats_clock t;
+    int code;
+
+    gx_stats_begin(mem, t);
+    code = pte->procs->process(pte);
+    gx_stats_end(mem, gx_stats_text, t);
+    return code;
 }
 
 /* Access elements of the enumerator. */
@@ -46,6 +46,18 @@ struct gs_uid_s {
 #define uid_is_XUID(puid)\
   ((puid)->id < 0)
 
+/*
+ * An XUID whose first value is uid_XUID_private has been made up by the
+ * interpreter for a font with no identity of its own, and means nothing
+ * outside the instance that made it (pdfi makes these from the file name
+ * and object number). If the second value is uid_XUID_has_digest, the
+ * next uid_XUID_digest_size values are a digest of the font program,
+ * which does identify the font anywhere (see gxshchar.h).
+ */
+#define uid_XUID_private 1000000
+#define uid_XUID_has_digest (-1)
+#define uid_XUID_digest_size 4
+
 /* Initialize a uid. */
 #define uid_set_UniqueID(puid, idv)\
   ((puid)->id = idv, (puid)->xvalues = 0)
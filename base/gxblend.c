@@ -29,6 +29,7 @@
 #ifdef WITH_CAL
 #include "cal.h"
 #endif
+#include "gxblendrow.h"
 
 typedef int art_s32;
 
@@ -3038,6 +3039,54 @@ compose_group_nonknockout_blend(byte *tos_ptr, bool tos_isolated, int tos_planes
         backdrop_ptr, has_matte, n_chan, additive, num_spots, overprint, drawn_comps, x0, y0, x1, y1, pblend_procs, pdev, 1);
 }
 
+#ifdef HAVE_SSE2
+/* Composite a group a row at a time with the row compositors in
+ * gxblendrow.c. The caller must have checked that this is one of the
+ * cases that they handle (see gxblendrow.h), and that any soft mask
+ * covers the whole area. */
+static void
+compose_group_rows(byte *tos_ptr, bool tos_isolated, int tos_planestride, int tos_rowstride,
+                   int tos_alpha_g_offset, byte *nos_ptr, int nos_planestride, int nos_rowstride,
+                   byte *mask_row_ptr, pdf14_buf *maskbuf, const byte *mask_tr_fn, byte alpha,
+                   gs_blend_mode_t blend_mode, bool additive, bool clear_copy,
+                   int n_chan, int width, int height)
+{
+    gx_blend_row_t row;
+
+    row.tos_ptr = tos_ptr;
+    row.tos_planestride = tos_planestride;
+    row.tos_alpha_g_ptr = tos_ptr + tos_alpha_g_offset;
+    row.nos_ptr = nos_ptr;
+    row.nos_planestride = nos_planestride;
+    row.mask_ptr = mask_row_ptr;
+    row.mask_tr_fn = mask_tr_fn;
+    row.n_chan = n_chan;
+    row.alpha = alpha;
+    row.isolated = tos_isolated;
+    row.subtractive = !additive;
+    row.blend_mode = blend_mode == BLEND_MODE_Multiply ? GX_BLEND_ROW_MULTIPLY :
+                     blend_mode == BLEND_MODE_Screen ? GX_BLEND_ROW_SCREEN : GX_BLEND_ROW_NORMAL;
+    row.clear_copy = clear_copy;
+
+    for (; height > 0; --height) {
+        gx_blend_row_8_sse2(&row, width);
+        row.tos_ptr += tos_rowstride;
+        row.tos_alpha_g_ptr += tos_rowstride;
+        row.nos_ptr += nos_rowstride;
+        if (row.mask_ptr != NULL)
+            row.mask_ptr += maskbuf->rowstride;
+    }
+}
+
+/* Does the soft mask cover the whole of the area being composited? */
+static bool
+mask_covers(const pdf14_buf *maskbuf, int x0, int y0, int x1, int y1)
+{
+    return maskbuf->rect.p.x <= x0 && maskbuf->rect.p.y <= y0 &&
+           maskbuf->rect.q.x >= x1 && maskbuf->rect.q.y >= y1;
+}
+#endif
+
 static void
 compose_group_nonknockout_nonblend_isolated_allmask_common(byte *tos_ptr, bool tos_isolated, int tos_planestride, int tos_rowstride, byte alpha, byte shape, gs_blend_mode_t blend_mode, bool tos_has_shape,
               int tos_shape_offset, int tos_alpha_g_offset, int tos_tag_offset, bool tos_has_tag, byte *tos_alpha_g_ptr,
@@ -3049,6 +3098,13 @@ compose_group_nonknockout_nonblend_isolated_allmask_common(byte *tos_ptr, bool t
               const pdf14_nonseparable_blending_procs_t *pblend_procs, pdf14_device *pdev)
 {
     int width = x1 - x0;
+#ifdef HAVE_SSE2
+    /* A zero backdrop alpha has always been a copy here, even where the
+       mask takes the source alpha to 0, hence clear_copy. */
+    compose_group_rows(tos_ptr, 1, tos_planestride, tos_rowstride, tos_alpha_g_offset,
+                       nos_ptr, nos_planestride, nos_rowstride, mask_row_ptr, maskbuf, mask_tr_fn,
+                       alpha, BLEND_MODE_Normal, 1, 1, n_chan, width, y1 - y0);
+#else
     int x, y;
     int i;
 
@@ -3101,6 +3157,7 @@ compose_group_nonknockout_nonblend_isolated_allmask_common(byte *tos_ptr, bool t
         nos_ptr += nos_rowstride - width;
         mask_row_ptr += maskbuf->rowstride;
     }
+#endif
 }
 
 static void
@@ -3203,11 +3260,17 @@ compose_group_nonknockout_nonblend_isolated_nomask_common(byte *tos_ptr, bool to
               bool has_matte, int n_chan, bool additive, int num_spots, bool overprint, gx_color_index drawn_comps, int x0, int y0, int x1, int y1,
               const pdf14_nonseparable_blending_procs_t *pblend_procs, pdf14_device *pdev)
 {
+#ifdef HAVE_SSE2
+    compose_group_rows(tos_ptr, 1, tos_planestride, tos_rowstride, tos_alpha_g_offset,
+                       nos_ptr, nos_planestride, nos_rowstride, NULL, NULL, NULL,
+                       alpha, BLEND_MODE_Normal, 1, 0, n_chan, x1 - x0, y1 - y0);
+#else
     template_compose_group(tos_ptr, /*tos_isolated*/1, tos_planestride, tos_rowstride, alpha, shape, BLEND_MODE_Normal, /*tos_has_shape*/0,
         tos_shape_offset, tos_alpha_g_offset, tos_tag_offset, /*tos_has_tag*/0, /*tos_alpha_g_ptr*/0,
         nos_ptr, /*nos_isolated*/0, nos_planestride, nos_rowstride, /*nos_alpha_g_ptr*/0, /* nos_knockout = */0,
         /*nos_shape_offset*/0, /*nos_tag_offset*/0, mask_row_ptr, /*has_mask*/0, /*maskbuf*/NULL, mask_bg_alpha, mask_tr_fn,
         backdrop_ptr, /*has_matte*/0, n_chan, /*additive*/1, /*num_spots*/0, /*overprint*/0, /*drawn_comps*/0, x0, y0, x1, y1, pblend_procs, pdev, 1);
+#endif
 }
 
 static void
@@ -3220,6 +3283,18 @@ compose_group_nonknockout_nonblend_nonisolated_mask_common(byte *tos_ptr, bool t
               bool has_matte, int n_chan, bool additive, int num_spots, bool overprint, gx_color_index drawn_comps, int x0, int y0, int x1, int y1,
               const pdf14_nonseparable_blending_procs_t *pblend_procs, pdf14_device *pdev)
 {
+#ifdef HAVE_SSE2
+    /* Without mask data, every pixel is outside the mask and gets the
+       background alpha. */
+    if (!has_mask || mask_covers(maskbuf, x0, y0, x1, y1)) {
+        compose_group_rows(tos_ptr, 0, tos_planestride, tos_rowstride, tos_alpha_g_offset,
+                           nos_ptr, nos_planestride, nos_rowstride,
+                           has_mask ? mask_row_ptr : NULL, maskbuf, mask_tr_fn,
+                           has_mask ? alpha : mask_bg_alpha, BLEND_MODE_Normal, 1, 0,
+                           n_chan, x1 - x0, y1 - y0);
+        return;
+    }
+#endif
     template_compose_group(tos_ptr, /*tos_isolated*/0, tos_planestride, tos_rowstride, alpha, shape, BLEND_MODE_Normal, /*tos_has_shape*/0,
         tos_shape_offset, tos_alpha_g_offset, tos_tag_offset, /*tos_has_tag*/0, /*tos_alpha_g_ptr*/0,
         nos_ptr, /*nos_isolated*/0, nos_planestride, nos_rowstride, /*nos_alpha_g_ptr*/0, /* nos_knockout = */0,
@@ -3237,12 +3312,39 @@ compose_group_nonknockout_nonblend_nonisolated_nomask_common(byte *tos_ptr, bool
               bool has_matte, int n_chan, bool additive, int num_spots, bool overprint, gx_color_index drawn_comps, int x0, int y0, int x1, int y1,
               const pdf14_nonseparable_blending_procs_t *pblend_procs, pdf14_device *pdev)
 {
+#ifdef HAVE_SSE2
+    compose_group_rows(tos_ptr, 0, tos_planestride, tos_rowstride, tos_alpha_g_offset,
+                       nos_ptr, nos_planestride, nos_rowstride, NULL, NULL, NULL,
+                       alpha, BLEND_MODE_Normal, 1, 0, n_chan, x1 - x0, y1 - y0);
+#else
     template_compose_group(tos_ptr, /*tos_isolated*/0, tos_planestride, tos_rowstride, alpha, shape, BLEND_MODE_Normal, /*tos_has_shape*/0,
         tos_shape_offset, tos_alpha_g_offset, tos_tag_offset, /*tos_has_tag*/0, /*tos_alpha_g_ptr*/0,
         nos_ptr, /*nos_isolated*/0, nos_planestride, nos_rowstride, /*nos_alpha_g_ptr*/0, /* nos_knockout = */0,
         /*nos_shape_offset*/0, /*nos_tag_offset*/0, mask_row_ptr, /*has_mask*/0, /*maskbuf*/NULL, mask_bg_alpha, mask_tr_fn,
         backdrop_ptr, /*has_matte*/0, n_chan, /*additive*/1, /*num_spots*/0, /*overprint*/0, /*drawn_comps*/0, x0, y0, x1, y1, pblend_procs, pdev, 1);
+#endif
+}
+
+#ifdef HAVE_SSE2
+/* Multiply and Screen, for groups as simple as those above. Any soft mask
+   covers the whole area. */
+static void
+compose_group_nonknockout_blend_simple(byte *tos_ptr, bool tos_isolated, int tos_planestride, int tos_rowstride, byte alpha, byte shape, gs_blend_mode_t blend_mode, bool tos_has_shape,
+              int tos_shape_offset, int tos_alpha_g_offset, int tos_tag_offset, bool tos_has_tag, byte *tos_alpha_g_ptr,
+              byte *nos_ptr, bool nos_isolated, int nos_planestride, int nos_rowstride, byte *nos_alpha_g_ptr, bool nos_knockout,
+              int nos_shape_offset, int nos_tag_offset,
+              byte *mask_row_ptr, int has_mask, pdf14_buf *maskbuf, byte mask_bg_alpha, const byte *mask_tr_fn,
+              byte *backdrop_ptr,
+              bool has_matte, int n_chan, bool additive, int num_spots, bool overprint, gx_color_index drawn_comps, int x0, int y0, int x1, int y1,
+              const pdf14_nonseparable_blending_procs_t *pblend_procs, pdf14_device *pdev)
+{
+    compose_group_rows(tos_ptr, tos_isolated, tos_planestride, tos_rowstride, tos_alpha_g_offset,
+                       nos_ptr, nos_planestride, nos_rowstride,
+                       has_mask ? mask_row_ptr : NULL, maskbuf, mask_tr_fn,
+                       has_mask || maskbuf == NULL ? alpha : mask_bg_alpha, blend_mode, additive, 0,
+                       n_chan, x1 - x0, y1 - y0);
 }
+#endif
 
 static void
 compose_group_nonknockout_noblend_general(byte *tos_ptr, bool tos_isolated, int tos_planestride, int tos_rowstride, byte alpha, byte shape, gs_blend_mode_t blend_mode, bool tos_has_shape,
@@ -3338,6 +3440,7 @@ do_compose_group(pdf14_buf *tos, pdf14_buf *nos, pdf14_buf *maskbuf,
     int width = x1 - x0;
 #endif
     art_pdf_compose_group_fn fn;
+    bool simple;
 
     if ((tos->n_chan == 0) || (nos->n_chan == 0))
         return;
@@ -3437,15 +3540,22 @@ do_compose_group(pdf14_buf *tos, pdf14_buf *nos, pdf14_buf *maskbuf,
     }
 #endif
 
+    simple = tos->has_shape == 0 && tos_has_tag == 0 && nos_isolated == 0 && nos_alpha_g_ptr == NULL &&
+             nos_shape_offset == 0 && nos_tag_offset == 0 && backdrop_ptr == NULL && has_matte == 0 && num_spots == 0 &&
+             overprint == 0 && tos_alpha_g_ptr == NULL;
+
     /* We have tested the files on the cluster to see what percentage of
      * files/devices hit the different options. */
     if (nos_knockout)
         fn = &compose_group_knockout; /* Small %ages, nothing more than 1.1% */
-    else if (blend_mode != 0)
+    else if (blend_mode != 0) {
         fn = &compose_group_nonknockout_blend; /* Small %ages, nothing more than 2% */
-    else if (tos->has_shape == 0 && tos_has_tag == 0 && nos_isolated == 0 && nos_alpha_g_ptr == NULL &&
-             nos_shape_offset == 0 && nos_tag_offset == 0 && backdrop_ptr == NULL && has_matte == 0 && num_spots == 0 &&
-             overprint == 0 && tos_alpha_g_ptr == NULL) {
+#ifdef HAVE_SSE2
+        if ((blend_mode == BLEND_MODE_Multiply || blend_mode == BLEND_MODE_Screen) && simple &&
+            (!has_mask || mask_covers(maskbuf, x0, y0, x1, y1)))
+            fn = &compose_group_nonknockout_blend_simple;
+#endif
+    } else if (simple) {
              /* Additive vs Subtractive makes no difference in normal blend mode with no spots */
         if (tos_isolated) {
             if (has_mask && maskbuf) {/* 7% */
@@ -0,0 +1,336 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  39 Mesa Street, Suite 108A, San Francisco,
+   CA 94129, USA, for further information.
+*/
+
+
+/* Row compositors for the common 8 bit pdf14 group cases */
+#include "std.h"
+#include "gxblendrow.h"
+#ifdef HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+/* The arithmetic below follows art_pdf_composite_group_8,
+ * art_pdf_recomposite_group_8, art_blend_pixel_8_inline and
+ * art_pdf_composite_pixel_alpha_8_inline in gxblend.c step for step, and
+ * must be kept in line with them. */
+
+void
+gx_blend_row_8(const gx_blend_row_t *row, int x0, int x1)
+{
+    const byte *tos_alpha_ptr = row->tos_ptr + row->n_chan * row->tos_planestride;
+    byte *nos_alpha_ptr = row->nos_ptr + row->n_chan * row->nos_planestride;
+    int comp = row->subtractive ? 0xff : 0;
+    int x, i;
+
+    for (x = x0; x < x1; x++) {
+        byte pix_alpha = row->alpha;
+        byte a_s, a_b = nos_alpha_ptr[x];
+        int tmp, scale = 0;
+        unsigned int a_r;
+        int src_scale;
+
+        if (row->mask_ptr != NULL) {
+            tmp = pix_alpha * row->mask_tr_fn[row->mask_ptr[x]] + 0x80;
+            pix_alpha = (tmp + (tmp >> 8)) >> 8;
+        }
+
+        if (row->isolated) {
+            a_s = tos_alpha_ptr[x];
+            if (a_s == 0)
+                continue;
+            if (pix_alpha != 255) {
+                tmp = a_s * pix_alpha + 0x80;
+                a_s = (tmp + (tmp >> 8)) >> 8;
+            }
+        } else {
+            byte alpha_g = row->tos_alpha_g_ptr[x];
+
+            if (alpha_g == 0)
+                continue;
+            if (row->blend_mode == GX_BLEND_ROW_NORMAL && pix_alpha == 255) {
+                /* Uncompositing and recompositing cancel each other out */
+                for (i = 0; i < row->n_chan; i++)
+                    row->nos_ptr[i * row->nos_planestride + x] =
+                        row->tos_ptr[i * row->tos_planestride + x];
+                nos_alpha_ptr[x] = tos_alpha_ptr[x];
+                continue;
+            }
+            /* Each colour is uncomposited below, with this scale */
+            if (alpha_g != 255 && a_b != 0)
+                scale = (a_b * 255 * 2 + alpha_g) / (alpha_g << 1) - a_b;
+            tmp = alpha_g * pix_alpha + 0x80;
+            a_s = (tmp + (tmp >> 8)) >> 8;
+        }
+        if (a_s == 0 && !(row->clear_copy && a_b == 0))
+            continue;
+
+        if (a_b == 0) {
+            /* Simple copy of colors plus alpha. */
+            for (i = 0; i < row->n_chan; i++)
+                row->nos_ptr[i * row->nos_planestride + x] =
+                    row->tos_ptr[i * row->tos_planestride + x];
+            nos_alpha_ptr[x] = a_s;
+            continue;
+        }
+
+        /* Result alpha is Union of backdrop and source alpha */
+        tmp = (0xff - a_b) * (0xff - a_s) + 0x80;
+        a_r = 0xff - (((tmp >> 8) + tmp) >> 8);
+
+        /* Compute a_s / a_r in 16.16 format */
+        src_scale = ((a_s << 16) + (a_r >> 1)) / a_r;
+
+        nos_alpha_ptr[x] = a_r;
+
+        for (i = 0; i < row->n_chan; i++) {
+            byte *nos = &row->nos_ptr[i * row->nos_planestride + x];
+            int c_s = row->tos_ptr[i * row->tos_planestride + x] ^ comp;
+            int c_b = *nos ^ comp;
+
+            if (scale != 0) {
+                tmp = (c_s - c_b) * scale + 0x80;
+                c_s += (tmp + (tmp >> 8)) >> 8;
+                if (c_s < 0)
+                    c_s = 0;
+                if (c_s > 255)
+                    c_s = 255;
+            }
+            if (row->blend_mode != GX_BLEND_ROW_NORMAL) {
+                int c_bl;
+
+                if (row->blend_mode == GX_BLEND_ROW_MULTIPLY)
+                    tmp = c_b * c_s + 0x80;
+                else
+                    tmp = (0xff - c_b) * (0xff - c_s) + 0x80;
+                c_bl = (tmp + (tmp >> 8)) >> 8;
+                if (row->blend_mode == GX_BLEND_ROW_SCREEN)
+                    c_bl = 0xff - c_bl;
+                /* Mix the blend result with the source colour */
+                tmp = a_b * (c_bl - c_s) + 0x80;
+                c_s += ((tmp >> 8) + tmp) >> 8;
+            }
+            tmp = (c_b << 16) + src_scale * (c_s - c_b) + 0x8000;
+            *nos = (tmp >> 16) ^ comp;
+        }
+    }
+}
+
+#ifdef HAVE_SSE2
+/* (v + 0x80) / 255 with the same rounding as the scalar code, on 16 bit
+ * lanes. v must be no greater than 255 * 255. */
+static forceinline __m128i
+div255_sse2(__m128i v)
+{
+    v = _mm_add_epi16(v, _mm_set1_epi16(0x80));
+    return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+}
+
+static forceinline __m128i
+load8_sse2(const byte *p)
+{
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p), _mm_setzero_si128());
+}
+
+static forceinline __m128i
+select_sse2(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/* trunc(num / den) on 16 bit lanes, as 32 bit lanes. num must be below
+ * 1 << 24 and den nonzero: then the float quotient is correctly rounded,
+ * and truncates to the same integer as the exact one. */
+static forceinline void
+div_sse2(__m128i num_lo, __m128i num_hi, __m128i den, __m128i *q_lo, __m128i *q_hi)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    *q_lo = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(num_lo),
+                                        _mm_cvtepi32_ps(_mm_unpacklo_epi16(den, zero))));
+    *q_hi = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(num_hi),
+                                        _mm_cvtepi32_ps(_mm_unpackhi_epi16(den, zero))));
+}
+
+/* Split a 32 bit scale below 1 << 17 into 32768 * hi + lo, so that the
+ * products in mul_scale_sse2 can be done with pmaddwd. */
+static forceinline void
+split_scale_sse2(__m128i s_lo, __m128i s_hi, __m128i *lo, __m128i *hi)
+{
+    const __m128i lo_mask = _mm_set1_epi32(0x7fff);
+
+    *lo = _mm_packs_epi32(_mm_and_si128(s_lo, lo_mask), _mm_and_si128(s_hi, lo_mask));
+    *hi = _mm_packs_epi32(_mm_srli_epi32(s_lo, 15), _mm_srli_epi32(s_hi, 15));
+}
+
+/* scale * v as 32 bit lanes, for -255 <= v <= 255 and a scale split by
+ * split_scale_sse2. */
+static forceinline void
+mul_scale_sse2(__m128i v, __m128i lo, __m128i hi, __m128i *p_lo, __m128i *p_hi)
+{
+    const __m128i k4000 = _mm_set1_epi16(0x4000);
+    __m128i v_h = _mm_mullo_epi16(hi, _mm_add_epi16(v, v));
+
+    *p_lo = _mm_madd_epi16(_mm_unpacklo_epi16(lo, v_h), _mm_unpacklo_epi16(v, k4000));
+    *p_hi = _mm_madd_epi16(_mm_unpackhi_epi16(lo, v_h), _mm_unpackhi_epi16(v, k4000));
+}
+
+/* Composite 8 pixels at a time, finishing the row with gx_blend_row_8.
+ * The steps are those of gx_blend_row_8, done on 16 bit lanes for the
+ * 8 pixels at once, with 32 bit lanes wherever a product can overflow;
+ * lanes that the scalar code would skip are merged back unchanged at the
+ * end. */
+void
+gx_blend_row_8_sse2(const gx_blend_row_t *row, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i ff = _mm_set1_epi16(0xff);
+    const __m128i k80 = _mm_set1_epi16(0x80);
+    const __m128i round = _mm_set1_epi32(0x8000);
+    const __m128i comp = _mm_set1_epi16(row->subtractive ? 0xff : 0);
+    const byte *tos_alpha_ptr = row->tos_ptr + row->n_chan * row->tos_planestride;
+    byte *nos_alpha_ptr = row->nos_ptr + row->n_chan * row->nos_planestride;
+    int x, i;
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        __m128i pix_alpha, g, a_s, a_b, a_r, skip, copy, num_lo, num_hi;
+        __m128i s_lo, s_hi, scale_l, scale_h, unc_l = zero, unc_h = zero, unc = zero;
+
+        g = load8_sse2(row->isolated ? tos_alpha_ptr + x : row->tos_alpha_g_ptr + x);
+        skip = _mm_cmpeq_epi16(g, zero);
+        if (_mm_movemask_epi8(skip) == 0xffff)
+            continue;
+
+        if (row->mask_ptr != NULL) {
+            byte mask[8];
+
+            for (i = 0; i < 8; i++)
+                mask[i] = row->mask_tr_fn[row->mask_ptr[x + i]];
+            pix_alpha = div255_sse2(_mm_mullo_epi16(load8_sse2(mask), _mm_set1_epi16(row->alpha)));
+        } else
+            pix_alpha = _mm_set1_epi16(row->alpha);
+        a_b = load8_sse2(nos_alpha_ptr + x);
+
+        /* Exact when pix_alpha == 255, so no need to special case it */
+        a_s = div255_sse2(_mm_mullo_epi16(g, pix_alpha));
+        copy = zero;
+        if (!row->isolated) {
+            if (row->blend_mode == GX_BLEND_ROW_NORMAL) {
+                copy = _mm_andnot_si128(skip, _mm_cmpeq_epi16(pix_alpha, ff));
+                if (_mm_movemask_epi8(_mm_or_si128(copy, skip)) == 0xffff) {
+                    /* Nothing but copies, as always with no mask and
+                       alpha 255 */
+                    __m128i copy8 = _mm_packs_epi16(copy, copy);
+
+                    for (i = 0; i <= row->n_chan; i++) {
+                        byte *nos_chan = row->nos_ptr + i * row->nos_planestride + x;
+                        __m128i tos = _mm_loadl_epi64((const __m128i *)(row->tos_ptr + i * row->tos_planestride + x));
+
+                        _mm_storel_epi64((__m128i *)nos_chan,
+                                         select_sse2(copy8, tos, _mm_loadl_epi64((const __m128i *)nos_chan)));
+                    }
+                    continue;
+                }
+            }
+            /* (a_b * 510 + g) / (2 * g) - a_b where g != 255 and a_b != 0 */
+            unc = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi16(g, ff), _mm_cmpeq_epi16(a_b, zero)),
+                                   _mm_cmpeq_epi16(zero, zero));
+            num_lo = _mm_madd_epi16(_mm_unpacklo_epi16(a_b, g), _mm_set1_epi32(0x000101fe));
+            num_hi = _mm_madd_epi16(_mm_unpackhi_epi16(a_b, g), _mm_set1_epi32(0x000101fe));
+            div_sse2(num_lo, num_hi, _mm_add_epi16(_mm_max_epi16(g, one), _mm_max_epi16(g, one)), &s_lo, &s_hi);
+            s_lo = _mm_sub_epi32(s_lo, _mm_unpacklo_epi16(a_b, zero));
+            s_hi = _mm_sub_epi32(s_hi, _mm_unpackhi_epi16(a_b, zero));
+            split_scale_sse2(s_lo, s_hi, &unc_l, &unc_h);
+        }
+        if (row->clear_copy)
+            skip = _mm_or_si128(skip, _mm_andnot_si128(_mm_cmpeq_epi16(a_b, zero), _mm_cmpeq_epi16(a_s, zero)));
+        else
+            skip = _mm_or_si128(skip, _mm_cmpeq_epi16(a_s, zero));
+        skip = _mm_andnot_si128(copy, skip);
+        if (_mm_movemask_epi8(skip) == 0xffff)
+            continue;
+
+        /* Result alpha is Union of backdrop and source alpha. Where a_b is
+           0 this gives a_r = a_s and (below) src_scale = 1.0, i.e. a copy. */
+        a_r = _mm_sub_epi16(ff, div255_sse2(_mm_mullo_epi16(_mm_sub_epi16(ff, a_b),
+                                                            _mm_sub_epi16(ff, a_s))));
+
+        /* Compute a_s / a_r in 16.16 format. The quotient is at most
+           65536.5, so fits the split used by mul_scale_sse2. */
+        num_lo = _mm_unpacklo_epi16(zero, a_s);
+        num_hi = _mm_unpackhi_epi16(zero, a_s);
+        num_lo = _mm_add_epi32(num_lo, _mm_unpacklo_epi16(_mm_srli_epi16(a_r, 1), zero));
+        num_hi = _mm_add_epi32(num_hi, _mm_unpackhi_epi16(_mm_srli_epi16(a_r, 1), zero));
+        div_sse2(num_lo, num_hi, _mm_max_epi16(a_r, one), &s_lo, &s_hi);
+        split_scale_sse2(s_lo, s_hi, &scale_l, &scale_h);
+        /* A zero a_b is a copy even if a_s has been scaled down to 0 */
+        scale_h = _mm_or_si128(scale_h, _mm_and_si128(_mm_cmpeq_epi16(a_b, zero), _mm_set1_epi16(2)));
+
+        a_r = select_sse2(copy, load8_sse2(tos_alpha_ptr + x), a_r);
+        a_r = select_sse2(skip, a_b, a_r);
+        _mm_storel_epi64((__m128i *)(nos_alpha_ptr + x), _mm_packus_epi16(a_r, zero));
+
+        for (i = 0; i < row->n_chan; i++) {
+            byte *nos_chan = row->nos_ptr + i * row->nos_planestride + x;
+            __m128i tos = load8_sse2(row->tos_ptr + i * row->tos_planestride + x);
+            __m128i nos = load8_sse2(nos_chan);
+            __m128i c_s = _mm_xor_si128(tos, comp);
+            __m128i c_b = _mm_xor_si128(nos, comp);
+            __m128i t_lo, t_hi, res;
+
+            if (!row->isolated) {
+                /* Uncomposite: c_s + (((c_s - c_b) * scale + 0x80) / 255),
+                   clamped to 0..255 */
+                mul_scale_sse2(_mm_sub_epi16(c_s, c_b), unc_l, unc_h, &t_lo, &t_hi);
+                t_lo = _mm_add_epi32(t_lo, _mm_set1_epi32(0x80));
+                t_hi = _mm_add_epi32(t_hi, _mm_set1_epi32(0x80));
+                t_lo = _mm_srai_epi32(_mm_add_epi32(t_lo, _mm_srai_epi32(t_lo, 8)), 8);
+                t_hi = _mm_srai_epi32(_mm_add_epi32(t_hi, _mm_srai_epi32(t_hi, 8)), 8);
+                t_lo = _mm_add_epi32(t_lo, _mm_unpacklo_epi16(c_s, zero));
+                t_hi = _mm_add_epi32(t_hi, _mm_unpackhi_epi16(c_s, zero));
+                res = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(t_lo, t_hi), zero), ff);
+                c_s = select_sse2(unc, res, c_s);
+            }
+            if (row->blend_mode != GX_BLEND_ROW_NORMAL) {
+                __m128i c_bl;
+
+                if (row->blend_mode == GX_BLEND_ROW_MULTIPLY)
+                    c_bl = div255_sse2(_mm_mullo_epi16(c_b, c_s));
+                else
+                    c_bl = _mm_sub_epi16(ff, div255_sse2(_mm_mullo_epi16(_mm_sub_epi16(ff, c_b),
+                                                                         _mm_sub_epi16(ff, c_s))));
+                /* Mix: c_s + ((a_b * (c_bl - c_s) + 0x80) / 255) */
+                c_bl = _mm_sub_epi16(c_bl, c_s);
+                t_lo = _mm_madd_epi16(_mm_unpacklo_epi16(c_bl, one), _mm_unpacklo_epi16(a_b, k80));
+                t_hi = _mm_madd_epi16(_mm_unpackhi_epi16(c_bl, one), _mm_unpackhi_epi16(a_b, k80));
+                t_lo = _mm_srai_epi32(_mm_add_epi32(t_lo, _mm_srai_epi32(t_lo, 8)), 8);
+                t_hi = _mm_srai_epi32(_mm_add_epi32(t_hi, _mm_srai_epi32(t_hi, 8)), 8);
+                c_s = _mm_add_epi16(c_s, _mm_packs_epi32(t_lo, t_hi));
+            }
+
+            /* Do simple compositing of source over backdrop */
+            mul_scale_sse2(_mm_sub_epi16(c_s, c_b), scale_l, scale_h, &t_lo, &t_hi);
+            t_lo = _mm_srai_epi32(_mm_add_epi32(t_lo, round), 16);
+            t_hi = _mm_srai_epi32(_mm_add_epi32(t_hi, round), 16);
+            res = _mm_xor_si128(_mm_add_epi16(c_b, _mm_packs_epi32(t_lo, t_hi)), comp);
+            res = select_sse2(copy, tos, res);
+            res = select_sse2(skip, nos, res);
+            _mm_storel_epi64((__m128i *)nos_chan, _mm_packus_epi16(res, zero));
+        }
+    }
+
+    gx_blend_row_8(row, x, width);
+}
+#endif
@@ -0,0 +1,75 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  39 Mesa Street, Suite 108A, San Francisco,
+   CA 94129, USA, for further information.
+*/
+
+
+/* Row compositors for the common 8 bit pdf14 group cases */
+
+#ifndef gxblendrow_INCLUDED
+#  define gxblendrow_INCLUDED
+
+#include "stdpre.h"
+
+/*
+ * These composite one row of a non-knockout 8 bit group onto its parent
+ * (the "nos") for the cases that dominate real files: no shape, tag,
+ * alpha_g, spot or backdrop planes, no matte, and either no soft mask or
+ * a soft mask that covers the whole row. They exist separately from
+ * gxblend.c so that the SIMD versions can be checked bit for bit against
+ * the scalar ones by base/blendbench.c ("make blendbench"), which links
+ * this file and nothing else.
+ *
+ * gx_blend_row_8 gives exactly the results of template_compose_group in
+ * gxblend.c for these cases; gx_blend_row_8_sse2 gives exactly the
+ * results of gx_blend_row_8.
+ *
+ * Both isolated and non-isolated groups are handled, in Normal, Multiply
+ * and Screen. Not yet covered, and left on the existing scalar code: 16
+ * bit groups and the other blend modes. There is no NEON version; one
+ * would slot in next to the SSE2 one and be checked the same way.
+ */
+
+typedef enum {
+    GX_BLEND_ROW_NORMAL,
+    GX_BLEND_ROW_MULTIPLY,
+    GX_BLEND_ROW_SCREEN
+} gx_blend_row_mode_t;
+
+typedef struct gx_blend_row_s {
+    byte *tos_ptr;                  /* n_chan colour planes, then alpha */
+    int tos_planestride;
+    const byte *tos_alpha_g_ptr;    /* group alpha, non-isolated only */
+    byte *nos_ptr;                  /* n_chan colour planes, then alpha */
+    int nos_planestride;
+    const byte *mask_ptr;           /* NULL if there is no soft mask */
+    const byte *mask_tr_fn;
+    int n_chan;
+    byte alpha;
+    bool isolated;
+    bool subtractive;               /* complement colours for the blend */
+    gx_blend_row_mode_t blend_mode;
+    /* Where the backdrop is clear, copy the source colours even if the
+       source alpha has been scaled down to 0. The masked isolated Normal
+       code in gxblend.c has always done this, and it must not change. */
+    bool clear_copy;
+} gx_blend_row_t;
+
+/* Composite pixels x0 to x1 - 1 of the row. */
+void gx_blend_row_8(const gx_blend_row_t *row, int x0, int x1);
+
+#ifdef HAVE_SSE2
+void gx_blend_row_8_sse2(const gx_blend_row_t *row, int width);
+#endif
+
+#endif /* gxblendrow_INCLUDED */
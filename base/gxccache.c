@@ -37,6 +37,7 @@
 #include "gsimage.h"
 #include "gxhttile.h"
 #include "gsptype1.h"       /* for gx_dc_is_pattern1_color_with_trans */
+#include "gxstats.h"
 
 /* Forward references */
 static byte *compress_alpha_bits(const cached_char *, gs_memory_t *);
@@ -160,12 +161,14 @@ gx_lookup_cached_char(const gs_font * pfont, const cached_fm_pair * pair,
             if_debug4m('K', pfont->memory,
                        "[K]found "PRI_INTPTR" (depth=%d) for glyph=0x%lx, wmode=%d\n",
                        (intptr_t)cc, cc_depth(cc), (ulong)glyph, wmode);
+            gx_stats_count(pfont->memory, gx_stats_char_cache_hit);
             return cc;
         }
         chi++;
     }
     if_debug3m('K', pfont->memory, "[K]not found: glyph=0x%lx, wmode=%d, depth=%d\n",
               (ulong) glyph, wmode, depth);
+    gx_stats_count(pfont->memory, gx_stats_char_cache_miss);
     return 0;
 }
 
@@ -35,6 +35,7 @@
 #include "gxttfb.h"
 #include "gxfont42.h"
 #include "gxobj.h"
+#include "gxshchar.h"
 
 /* Define the descriptors for the cache structures. */
 private_st_cached_fm_pair();
@@ -599,7 +600,7 @@ int
 gx_add_cached_char(gs_font_dir * dir, gx_device_memory * dev,
 cached_char * cc, cached_fm_pair * pair, const gs_log2_scale_point * pscale)
 {
-    if_debug5m('k', dev->memory,
+    if_debug5m('k', dir->memory,
                "[k]chaining char "PRI_INTPTR": pair="PRI_INTPTR", glyph=0x%lx, wmode=%d, depth=%d\n",
                (intptr_t)cc, (intptr_t)pair, (ulong)cc->code,
                cc->wmode, cc_depth(cc));
@@ -775,6 +776,231 @@ gx_add_char_bits(gs_font_dir * dir, cached_char * cc,
     cc->id = gs_next_ids(dir->memory, 1);
 }
 
+/* ------ Sharing characters between instances (see gxshchar.h) ------ */
+
+/*
+ * The key is everything the bits depend on, followed by any XUID values
+ * and, for named glyphs, the name: name indices mean nothing outside
+ * the instance that made them.
+ */
+typedef struct shared_char_key_s {
+    float mxx, mxy, myx, myy;
+    gs_fixed_point subpix_origin;
+    long uid;                   /* as gs_uid.id */
+    int uid_is_digest;
+    gs_glyph glyph;             /* or the length of the name */
+    int glyph_kind;             /* see below */
+    int FontType;
+    int depth;
+    int wmode;
+    int design_grid;
+    int grid_fit_tt;
+    int align_to_pixels;
+} shared_char_key_t;
+
+enum {
+    shared_glyph_code,          /* CID or other number */
+    shared_glyph_name,
+    shared_glyph_index          /* TrueType glyph index */
+};
+
+#define max_shared_char_key 256
+
+/* The value is this, followed by the bits. */
+typedef struct shared_char_value_s {
+    gs_fixed_point wxy;
+    gs_fixed_point offset;
+    uint raster;
+    ushort width, height;
+} shared_char_value_t;
+
+/* Build the key in buf, returning its size, or 0 if the character */
+/* can't be shared. */
+static uint
+shared_char_key(gs_font *font, const cached_fm_pair *pair, gs_glyph glyph,
+                int wmode, int depth, const gs_fixed_point *subpix_origin,
+                byte *buf)
+{
+    shared_char_key_t key;
+    const long *xvalues = NULL;
+    uint xsize = 0;
+    gs_const_string gname;
+    uint size;
+
+    if (!uid_is_valid(&pair->UID))
+        return 0;
+    memset(&key, 0, sizeof(key));       /* no stray padding */
+    key.uid = pair->UID.id;
+    if (uid_is_XUID(&pair->UID)) {
+        xvalues = uid_XUID_values(&pair->UID);
+        xsize = uid_XUID_size(&pair->UID);
+        if (xvalues[0] == uid_XUID_private) {
+            /*
+             * Only the digest of the font program means anything here, and
+             * only for simple fonts: the widths of CIDFonts can come from
+             * elsewhere.
+             */
+            if (xsize < 2 + uid_XUID_digest_size || xvalues[1] != uid_XUID_has_digest)
+                return 0;
+            switch (pair->FontType) {
+                case ft_encrypted:
+                case ft_encrypted2:
+                case ft_TrueType:
+                    break;
+                default:
+                    return 0;
+            }
+            xvalues += 2;
+            xsize = uid_XUID_digest_size;
+            key.uid = -(long)xsize;
+            key.uid_is_digest = 1;
+        }
+    }
+    key.mxx = pair->mxx, key.mxy = pair->mxy;
+    key.myx = pair->myx, key.myy = pair->myy;
+    key.subpix_origin = *subpix_origin;
+    key.FontType = pair->FontType;
+    key.depth = depth;
+    key.wmode = wmode;
+    key.design_grid = pair->design_grid;
+    key.grid_fit_tt = font->dir->grid_fit_tt;
+    key.align_to_pixels = font->dir->align_to_pixels;
+    gname.size = 0;
+    if (font->FontType == ft_TrueType || font->FontType == ft_CID_TrueType) {
+        /* Whatever the glyph is, it ends up as a glyph index. */
+        gs_font_type42 *pfont42 = (gs_font_type42 *)font;
+
+        key.glyph_kind = shared_glyph_index;
+        key.glyph = pfont42->data.get_glyph_index(pfont42, glyph);
+    } else if (glyph < GS_MIN_CID_GLYPH) {
+        if (font->procs.glyph_name(font, glyph, &gname) < 0)
+            return 0;
+        key.glyph_kind = shared_glyph_name;
+        key.glyph = gname.size;
+    } else {
+        key.glyph_kind = shared_glyph_code;
+        key.glyph = glyph;
+    }
+    size = sizeof(key) + xsize * sizeof(long) + gname.size;
+    if (size > max_shared_char_key)
+        return 0;
+    memcpy(buf, &key, sizeof(key));
+    if (xsize > 0)
+        memcpy(buf + sizeof(key), xvalues, xsize * sizeof(long));
+    if (gname.size > 0)
+        memcpy(buf + sizeof(key) + xsize * sizeof(long), gname.data, gname.size);
+    return size;
+}
+
+typedef struct shared_char_import_s {
+    gs_font_dir *dir;
+    cached_char *cc;
+} shared_char_import_t;
+
+/* Copy a shared character into the local cache (gx_shared_char_proc_t). */
+static int
+import_shared_char(void *arg, const byte *value, uint size)
+{
+    shared_char_import_t *imp = (shared_char_import_t *)arg;
+    shared_char_value_t v;
+    uint bsize;
+    cached_char *cc;
+    int code;
+
+    memcpy(&v, value, sizeof(v));
+    bsize = v.raster * v.height;
+    if (size != sizeof(v) + bsize)
+        return 0;
+    if (v.raster != 0 && v.height > imp->dir->ccache.upper / v.raster)
+        return 0;		/* too big for this cache */
+    code = alloc_char(imp->dir, sizeof_cached_char + bsize, &cc);
+    if (code < 0 || cc == 0)
+        return code;
+    memcpy(cc_bits(cc), value + sizeof(v), bsize);
+    cc->width = v.width;
+    cc->height = v.height;
+    cc->shift = 0;
+    cc_set_raster(cc, v.raster);
+    cc->wxy = v.wxy;
+    cc->offset = v.offset;
+    imp->cc = cc;
+    return 1;
+}
+
+/*
+ * Look for a character in the shared cache, after missing in the local
+ * one. If it is there, copy it into the local cache and return it in
+ * *pcc, just as if we had rendered it; otherwise set *pcc to 0.
+ */
+int
+gx_lookup_shared_char(gs_font * font, cached_fm_pair * pair, gs_glyph glyph,
+                      int wmode, int depth, const gs_fixed_point * subpix_origin,
+                      cached_char ** pcc)
+{
+    gs_font_dir *dir = font->dir;
+    byte key[max_shared_char_key];
+    uint key_size;
+    shared_char_import_t imp;
+    cached_char *cc;
+    int code;
+
+    *pcc = 0;
+    if (!gx_shared_char_cache_active(dir->memory))
+        return 0;
+    key_size = shared_char_key(font, pair, glyph, wmode, depth, subpix_origin, key);
+    if (key_size == 0)
+        return 0;
+    imp.dir = dir;
+    imp.cc = 0;
+    code = gx_shared_char_cache_lookup(dir->memory, key, key_size,
+                                       import_shared_char, &imp);
+    if (code <= 0)
+        return code;
+    cc = imp.cc;
+    cc_set_depth(cc, depth);
+    cc->xglyph = gx_no_xglyph;
+    cc_set_pair_only(cc, 0);
+    cc->linked = false;
+    cc->code = glyph;
+    cc->wmode = wmode;
+    cc->subpix_origin = *subpix_origin;
+    cc->id = gs_next_ids(dir->memory, 1);
+    code = gx_add_cached_char(dir, NULL, cc, pair, NULL);
+    if (code < 0) {
+        gx_free_cached_char(dir, cc);
+        return code;
+    }
+    *pcc = cc;
+    return 0;
+}
+
+/* Offer a newly rendered character to the shared cache. */
+void
+gx_publish_shared_char(gs_font * font, const cached_fm_pair * pair,
+                       const cached_char * cc)
+{
+    gs_font_dir *dir = font->dir;
+    byte key[max_shared_char_key];
+    uint key_size;
+    shared_char_value_t v;
+
+    if (!gx_shared_char_cache_active(dir->memory) || !cc_has_bits(cc))
+        return;
+    key_size = shared_char_key(font, pair, cc->code, cc->wmode, cc_depth(cc),
+                               &cc->subpix_origin, key);
+    if (key_size == 0)
+        return;
+    memset(&v, 0, sizeof(v));
+    v.wxy = cc->wxy;
+    v.offset = cc->offset;
+    v.raster = cc_raster(cc);
+    v.width = cc->width;
+    v.height = cc->height;
+    gx_shared_char_cache_add(dir->memory, key, key_size,
+                             (const byte *)&v, sizeof(v),
+                             cc_const_bits(cc), cc_raster(cc) * cc->height);
+}
+
 /* Purge from the caches all references to a given font. */
 static int
 gs_purge_font_from_char_caches_forced(gs_font * font, bool force)
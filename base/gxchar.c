@@ -826,6 +826,7 @@ show_update(gs_show_enum * penum)
                                cc, pair, &penum->log2_scale);
                 if (code < 0)
                     return code;
+                gx_publish_shared_char(pgs->font, pair, cc);
             }
             if (!SHOW_USES_OUTLINE(penum) ||
                 penum->charpath_flag != cpm_show
@@ -1070,6 +1071,13 @@ show_proceed(gs_show_enum * penum)
                         }
                         cc = gx_lookup_cached_char(pfont, pair, glyph, wmode,
                                                    depth, &subpix_origin);
+                        if (cc == 0) {
+                            /* Another instance may have rendered it. */
+                            code = gx_lookup_shared_char(pfont, pair, glyph, wmode,
+                                                         depth, &subpix_origin, &cc);
+                            if (code < 0)
+                                return code;
+                        }
                     }
                     if (cc == 0) {
                         goto no_cache;
@@ -35,6 +35,11 @@
 #define CL_CACHE_SLOT_SIZE_LOG2 (15)
 #define CL_CACHE_SLOT_EMPTY (-1)
 
+/* Where the platform allows it, we read the file through a read only
+ * mapping rather than the cache above. As we read through the mapping we
+ * ask for the next CL_MAP_READAHEAD bytes to be brought in ahead of us. */
+#define CL_MAP_READAHEAD (1<<20)
+
 static clist_io_procs_t clist_io_procs_file;
 
 typedef struct
@@ -229,6 +234,10 @@ typedef struct
     int64_t pos;
     int64_t filesize;		/* filesize maintained by clist_fwrite */
     CL_CACHE *cache;
+    byte *map;			/* read only mapping of the file, or NULL */
+    int64_t map_size;		/* size of map, or -1 if mapping failed */
+    int64_t map_ahead;		/* end of the region we have asked to prefetch */
+    bool write_error;		/* a write failed or was short */
 } IFILE;
 
 static void
@@ -262,13 +271,46 @@ static IFILE *wrap_file(gs_memory_t *mem, gp_file *f, const char *fmode)
     ifile->pos = 0;
     ifile->filesize = 0;
     ifile->cache = cl_cache_alloc(ifile->mem);
+    ifile->map = NULL;
+    ifile->map_size = 0;
+    ifile->map_ahead = 0;
+    ifile->write_error = false;
     return ifile;
 }
 
+/* Drop any mapping of the file (e.g. because it has been written to). */
+static void
+clist_unmap_file(IFILE *ifile)
+{
+    if (ifile->map != NULL)
+        gp_fmunmap(ifile->map, (size_t)ifile->map_size);
+    ifile->map = NULL;
+    ifile->map_size = 0;
+    ifile->map_ahead = 0;
+}
+
+/* Map the file for reading, if we can. Returns true if the file is
+ * mapped. Once mapping has failed we don't try again until the file is
+ * written to. */
+static bool
+clist_map_file(IFILE *ifile)
+{
+    if (ifile->map != NULL)
+        return true;
+    if (ifile->map_size < 0 || ifile->filesize <= 0 ||
+        (uint64_t)ifile->filesize > (uint64_t)max_size_t)
+        return false;
+    ifile->map = gp_fmmap(ifile->f, (size_t)ifile->filesize);
+    ifile->map_size = ifile->map == NULL ? -1 : ifile->filesize;
+    ifile->map_ahead = 0;
+    return ifile->map != NULL;
+}
+
 static int clist_close_file(IFILE *ifile)
 {
     int res = 0;
     if (ifile) {
+        clist_unmap_file(ifile);
         if (ifile->f != NULL)
             res = gp_fclose(ifile->f);
         if (ifile->cache != NULL)
@@ -283,7 +325,7 @@ static int clist_close_file(IFILE *ifile)
 static int
 clist_fopen(char fname[gp_file_name_sizeof], const char *fmode,
             clist_file_ptr * pcf, gs_memory_t * mem, gs_memory_t *data_mem,
-            bool ok_to_compress)
+            int ok_to_compress)
 {
     if (*fname == 0) {
         if (fmode[0] == 'r')
@@ -365,9 +407,19 @@ clist_fwrite_chars(const void *data, uint len, clist_file_ptr cf)
     } else {
         res = gp_fwrite(data, 1, len, ((IFILE *)cf)->f);
     }
-    if (res >= 0)
-        icf->pos += len;
+    /* Only count what actually got written, as filesize bounds what we
+     * map for reading. A short write (e.g. a full disk) is an error. */
+    if (res > 0)
+        icf->pos += res;
     icf->filesize = icf->pos;	/* write truncates file */
+    if (res < 0 || (uint)res < len) {
+        icf->write_error = true;
+        res = gs_note_error(gs_error_ioerror);
+    }
+    if (icf->map_size != 0) {
+        /* writing invalidates the mapping (or allows us to try again) */
+        clist_unmap_file(icf);
+    }
     if (!CL_CACHE_NEEDS_INIT(icf->cache)) {
         /* writing invalidates the read cache */
         cl_cache_destroy(icf->cache);
@@ -387,6 +439,23 @@ clist_fread_chars(void *data, uint len, clist_file_ptr cf)
         IFILE *icf = (IFILE *)cf;
         byte *dp = data;
 
+        /* Reads from the mapping need no seeking, locking or cache slot
+         * juggling. Anything running off the end of it (a short read at
+         * the end of the file) takes the slow path below. */
+        if (clist_map_file(icf) && icf->pos >= 0 && icf->pos + len <= icf->map_size) {
+            if (icf->pos + len > icf->map_ahead) {
+                int64_t ahead = icf->map_size - icf->pos;
+
+                if (ahead > CL_MAP_READAHEAD)
+                    ahead = CL_MAP_READAHEAD;
+                gp_fmmap_prefetch(icf->map + icf->pos, (size_t)ahead);
+                icf->map_ahead = icf->pos + ahead;
+            }
+            memcpy(data, icf->map + icf->pos, len);
+            icf->pos += len;
+            return len;
+        }
+
         /* if we have a cache, check if it needs init, and do it */
         if (CL_CACHE_NEEDS_INIT(icf->cache)) {
             icf->cache = cl_cache_read_init(icf->cache, CL_CACHE_NSLOTS, 1<<CL_CACHE_SLOT_SIZE_LOG2, icf->filesize);
@@ -458,7 +527,7 @@ clist_set_memory_warning(clist_file_ptr cf, int bytes_left)
 static int
 clist_ferror_code(clist_file_ptr cf)
 {
-    return (gp_ferror(((IFILE *)cf)->f) ? gs_error_ioerror : 0);
+    return (((IFILE *)cf)->write_error || gp_ferror(((IFILE *)cf)->f) ? gs_error_ioerror : 0);
 }
 
 static int64_t
@@ -484,6 +553,7 @@ clist_rewind(clist_file_ptr cf, bool discard_data, const char *fname)
              * new scratch file. */
             char tfname[gp_file_name_sizeof] = {0};
             const gs_memory_t *mem = ocf->f->memory;
+            clist_unmap_file(ocf);
             gp_fclose(ocf->f);
             ocf->f = gp_open_scratch_file_rm(mem, gp_scratch_file_name_prefix, tfname, fmode);
             if (ocf->f == NULL)
@@ -497,6 +567,7 @@ clist_rewind(clist_file_ptr cf, bool discard_data, const char *fname)
                     return_error(gs_error_ioerror);
             }
             ((IFILE *)cf)->filesize = 0;
+            ((IFILE *)cf)->write_error = false;
         }
         ((IFILE *)cf)->pos = 0;
     } else {
@@ -509,12 +580,14 @@ clist_rewind(clist_file_ptr cf, bool discard_data, const char *fname)
              */
 
             /* Opening with "w" mode deletes the contents when closing. */
+            clist_unmap_file((IFILE *)cf);
             f = gp_freopen(fname, gp_fmode_wb, f);
             if (f == NULL) return_error(gs_error_ioerror);
             ((IFILE *)cf)->f = gp_freopen(fname, fmode, f);
             if (((IFILE *)cf)->f == NULL) return_error(gs_error_ioerror);
             ((IFILE *)cf)->pos = 0;
             ((IFILE *)cf)->filesize = 0;
+            ((IFILE *)cf)->write_error = false;
         } else {
             gp_rewind(f);
         }
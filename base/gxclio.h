@@ -31,6 +31,8 @@
 
 typedef void *clist_file_ptr;	/* We can't do any better than this. */
 
+#define CLIST_COMPRESS_FAST 2	/* see ok_to_compress below */
+
 struct clist_io_procs_s {
 
     /* ---------------- Open/close/unlink ---------------- */
@@ -40,11 +42,14 @@ struct clist_io_procs_s {
      * open an existing file.  Only modes "r" and "w+" are supported,
      * and only binary data (but the caller must append the "b" if needed).
      * Mode "r" with *fname = 0 is an error.
+     * ok_to_compress is false, true, or CLIST_COMPRESS_FAST to ask for
+     * the fastest compression of every block as it is written (only
+     * meaningful for files stored in RAM).
      */
     int (*fopen)(char fname[gp_file_name_sizeof], const char *fmode,
                     clist_file_ptr * pcf,
                     gs_memory_t * mem, gs_memory_t *data_mem,
-                    bool ok_to_compress);
+                    int ok_to_compress);
 
     /*
      * Close a file, optionally deleting it.
@@ -634,7 +634,8 @@ clist_open_output_file(gx_device *dev)
     clist_reset_page(cdev);
     if ((code = cdev->page_info.io_procs->fopen(cdev->page_info.cfname, fmode, &cdev->page_info.cfile,
                             cdev->bandlist_memory, cdev->bandlist_memory,
-                            true)) < 0 ||
+                            (cdev->band_params.BandListCompression == BandListCompressFast ?
+                             CLIST_COMPRESS_FAST : true))) < 0 ||
         (code = cdev->page_info.io_procs->fopen(cdev->page_info.bfname, fmode, &cdev->page_info.bfile,
                             cdev->bandlist_memory, cdev->bandlist_memory,
                             false)) < 0
@@ -383,6 +383,7 @@ struct gx_device_clist_writer_s {
 #define clist_disable_copy_alpha (1 << 6) /* target does not support copy_alpha */
 
 typedef struct clist_render_thread_control_s clist_render_thread_control_t;
+typedef struct clist_band_slot_s clist_band_slot_t;
 
 /* Define the state of a band list when reading. */
 /* For normal rasterizing, pages and num_pages are both 0. */
@@ -397,9 +398,16 @@ typedef struct gx_device_clist_reader_s {
     int num_render_threads;		/* number of threads being used */
     clist_render_thread_control_t *render_threads;	/* array of threads */
     byte *main_thread_data;		/* saved data pointer of main thread */
-    int curr_render_thread;		/* index into array */
     int thread_lookahead_direction;	/* +1 or -1 */
-    int next_band;			/* may be < 0 or >= num bands when no more remain to render */
+    int next_band;			/* next band for a thread to claim, may be < 0 or */
+                                        /* >= num bands when no more remain to render */
+    int next_band_out;			/* next band the main thread expects to consume */
+    int num_band_slots;			/* size of the band reorder buffer */
+    clist_band_slot_t *band_slots;	/* rendered bands waiting to be consumed in order */
+    gx_monitor_t *band_lock;		/* protects next_band and band_slots */
+    gx_semaphore_t *band_slots_free;	/* counts unclaimed slots, threads wait on this */
+    gx_semaphore_t *band_done;		/* signalled whenever a thread completes a band */
+    bool render_threads_stop;		/* tells the threads not to claim more bands */
 
 } gx_device_clist_reader;
 
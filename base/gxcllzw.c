@@ -22,14 +22,15 @@
 #include "slzwx.h"
 
 /* Return the prototypes for compressing/decompressing the band list. */
-const stream_template *clist_compressor_template(void)
+const stream_template *
+clist_compressor_template(void)
 {
-    return &cl_LZWE_template;
+    return &s_LZWE_template;
 }
 const stream_template *
-clist_decompressor_state(void)
+clist_decompressor_template(void)
 {
-    return &cl_LZWD_state;
+    return &s_LZWD_template;
 }
 void
 clist_compressor_init(stream_state *state)
@@ -43,3 +44,8 @@ clist_decompressor_init(stream_state *state)
     s_LZW_set_defaults(state);
     state->templat = &s_LZWD_template;
 }
+void
+clist_compressor_set_fast(stream_state *state)
+{
+    /* LZW has no speed/size trade off to make. */
+}
@@ -19,6 +19,7 @@
 #include "gx.h"
 #include "gserrors.h"
 #include "gxclmem.h"
+#include "gxsync.h"
 #include "gssprintf.h"
 
 #include "valgrind.h"
@@ -139,6 +140,10 @@ LIMITATIONS.
    As a testing measure we have a a define TEST_BAND_LIST_COMPRESSION
    which, if set, will set the threshold to a low value so as to cause
    compression to trigger.
+
+   Files opened with CLIST_COMPRESS_FAST (the BandListCompression device
+   parameter) ignore the threshold, and compress every block as soon as
+   it is full, using the compressor thread (see below).
  */
 static const int64_t COMPRESSION_THRESHOLD =
 #ifdef TEST_BAND_LIST_COMPRESSION
@@ -148,7 +153,8 @@ static const int64_t COMPRESSION_THRESHOLD =
 #endif
 
 #define NEED_TO_COMPRESS(f)\
-  ((f)->ok_to_compress && (f)->total_space > COMPRESSION_THRESHOLD)
+  ((f)->ok_to_compress &&\
+   ((f)->compress_eagerly || (f)->total_space > COMPRESSION_THRESHOLD))
 
    /* FOR NOW ALLOCATE 1 raw buffer for every 32 blocks (at least 8, no more than 64)    */
 #define GET_NUM_RAW_BUFFERS( f ) \
@@ -169,6 +175,8 @@ static int memfile_init_empty(MEMFILE * f);
 static int memfile_set_memory_warning(clist_file_ptr cf, int bytes_left);
 static int memfile_fclose(clist_file_ptr cf, const char *fname, bool delete);
 static int memfile_get_pdata(MEMFILE * f);
+static int memfile_collect_compressed(MEMFILE * f);
+static void memfile_stop_compressor(MEMFILE * f);
 
 /************************************************/
 /*   #define DEBUG      /- force statistics -/  */
@@ -238,7 +246,7 @@ allocateWithReserve(
 static int
 memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
               clist_file_ptr /*MEMFILE * */  * pf,
-              gs_memory_t *mem, gs_memory_t *data_mem, bool ok_to_compress)
+              gs_memory_t *mem, gs_memory_t *data_mem, int ok_to_compress)
 {
     MEMFILE *f = NULL;
     int code = 0;
@@ -256,6 +264,9 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
             code = gs_note_error(gs_error_ioerror);
             goto finish;
         }
+        /* Make sure that the writer's last block has been compressed */
+        if ((code = memfile_collect_compressed(base_f)) < 0)
+            goto finish;
         /* Reopen an existing file for 'read' */
         if (base_f->is_open == false) {
             /* File is not is use, just re-use it. */
@@ -279,6 +290,9 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
             f->data_memory = data_mem;
             f->compress_state = 0;              /* Not used by reader instance */
             f->decompress_state = 0;    /* make clean for GC, or alloc'n failure */
+            f->compress_eagerly = false;
+            f->compress_in_background = false;
+            f->compressor = NULL;
             f->reservePhysBlockChain = NULL;
             f->reservePhysBlockCount = 0;
             f->reserveLogBlockChain = NULL;
@@ -351,6 +365,9 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
     /* init an empty file, BEFORE allocating de/compress state */
     f->compress_state = 0;      /* make clean for GC, or alloc'n failure */
     f->decompress_state = 0;
+    f->compress_eagerly = (ok_to_compress == CLIST_COMPRESS_FAST);
+    f->compress_in_background = f->compress_eagerly;
+    f->compressor = NULL;
     f->openlist = NULL;
     f->base_memfile = NULL;
     f->total_space = 0;
@@ -395,6 +412,8 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
             (*compress_template->set_defaults) (f->compress_state);
         if (decompress_template->set_defaults)
             (*decompress_template->set_defaults) (f->decompress_state);
+        if (f->compress_eagerly)
+            clist_compressor_set_fast(f->compress_state);
     }
     f->total_space = 0;
 
@@ -430,8 +449,11 @@ static int
 memfile_fclose(clist_file_ptr cf, const char *fname, bool delete)
 {
     MEMFILE *const f = (MEMFILE *)cf;
+    int code;
 
     f->is_open = false;
+    if ((code = memfile_collect_compressed(f)) < 0)
+        return code;
     if (!delete) {
         if (f->base_memfile) {
             MEMFILE *prev_f;
@@ -454,23 +476,19 @@ memfile_fclose(clist_file_ptr cf, const char *fname, bool delete)
             /* If the file is compressed, free the logical blocks, but not */
             /* the phys_blk info (that is still used by the base memfile   */
             if (f->log_head->phys_blk->data_limit != NULL) {
-                LOG_MEMFILE_BLK *tmpbp, *bp = f->log_head;
-
-                while (bp != NULL) {
-                    tmpbp = bp->link;
-                    FREE(f, bp, "memfile_free_mem(log_blk)");
-                    bp = tmpbp;
-                }
+                /* memfile_fopen allocated the copy as a single array */
+                FREE(f, f->log_head, "memfile_free_mem(log_blk)");
                 f->log_head = NULL;
 
-                /* Free any internal compressor state. */
-                if (f->compressor_initialized) {
-                    if (f->decompress_state->templat->release != 0)
-                        (*f->decompress_state->templat->release) (f->decompress_state);
-                    if (f->compress_state->templat->release != 0)
-                        (*f->compress_state->templat->release) (f->compress_state);
-                    f->compressor_initialized = false;
-                }
+                /* Free the decompressor; a reader instance has no compressor. */
+                /* It was initialised when the raw buffers were allocated.     */
+                if (f->raw_head != NULL &&
+                    f->decompress_state->templat->release != 0)
+                    (*f->decompress_state->templat->release) (f->decompress_state);
+                gs_free_object(f->memory, f->decompress_state,
+                               "memfile_close_and_unlink(decompress_state)");
+                f->decompress_state = NULL;
+                f->compressor_initialized = false;
                 /* free the raw buffers                                           */
                 while (f->raw_head != NULL) {
                     RAW_BUFFER *tmpraw = f->raw_head->fwd;
@@ -496,6 +514,7 @@ memfile_fclose(clist_file_ptr cf, const char *fname, bool delete)
     } else {
         /* Free the memory used by this memfile */
         memfile_free_mem(f);
+        memfile_stop_compressor(f);
 
         /* Free reserve blocks; don't do it in memfile_free_mem because */
         /* that routine gets called to reinit file */
@@ -674,6 +693,198 @@ compress_log_blk(MEMFILE * f, LOG_MEMFILE_BLK * bp)
     return (status < 0 ? gs_note_error(gs_error_ioerror) : ecode);
 }                               /* end "compress_log_blk()"                                     */
 
+/* ---------------- Background compression ---------------- */
+
+/*
+   When compress_eagerly is set, every logical block is compressed as soon
+   as it is full. Rather than doing this in memfile_next_blk, the full block
+   is handed to a compressor thread, which compresses it into a buffer of
+   its own while the writer fills the next block. The writer collects the
+   result when it hands over the next block (or before anyone reads the
+   file) and appends it to the physical block chain, so the allocations
+   and the block chains are only ever touched by the writer.
+ */
+typedef struct MEMFILE_COMPRESSOR_s {
+    gs_memory_t *memory;
+    gp_thread_id thread;
+    gx_semaphore_t *start;      /* signalled when a block is queued, or to quit */
+    gx_semaphore_t *done;       /* signalled when the block has been compressed */
+    bool quit;
+    stream_state *state;        /* the MEMFILE's compress_state */
+    LOG_MEMFILE_BLK *bp;        /* block being compressed, NULL if idle */
+    PHYS_MEMFILE_BLK *raw;      /* the uncompressed data for bp */
+    PHYS_MEMFILE_BLK *spare;    /* a raw block ready for re-use */
+    int status;
+    uint size;
+    /* Room for an incompressible block, as compress_log_blk allows it the */
+    /* rest of one physical block and the whole of the next.              */
+    byte data[2 * MEMFILE_DATA_SIZE];           /* the compressed data for bp */
+} MEMFILE_COMPRESSOR;
+
+static void
+memfile_compress_thread(void *arg)
+{
+    MEMFILE_COMPRESSOR *c = (MEMFILE_COMPRESSOR *)arg;
+    stream_cursor_read rd;
+    stream_cursor_write wt;
+
+    for (;;) {
+        gx_semaphore_wait(c->start);
+        if (c->quit)
+            break;
+        if (c->state->templat->reinit != 0)
+            (*c->state->templat->reinit)(c->state);
+        rd.ptr = (const byte *)(c->raw->data) - 1;
+        rd.limit = rd.ptr + MEMFILE_DATA_SIZE;
+        wt.ptr = c->data - 1;
+        wt.limit = wt.ptr + sizeof(c->data);
+        c->status = (*c->state->templat->process)(c->state, &rd, &wt, true);
+        c->size = wt.ptr + 1 - c->data;
+        gx_semaphore_signal(c->done);
+    }
+}
+
+static int
+memfile_start_compressor(MEMFILE * f)
+{
+    gs_memory_t *mem = f->memory->non_gc_memory;
+    MEMFILE_COMPRESSOR *c;
+
+    c = (MEMFILE_COMPRESSOR *)gs_alloc_bytes(mem, sizeof(*c),
+                                             "memfile_start_compressor");
+    if (c == NULL)
+        return_error(gs_error_VMerror);
+    c->memory = mem;
+    c->quit = false;
+    c->state = f->compress_state;
+    c->bp = NULL;
+    c->raw = NULL;
+    c->spare = NULL;
+    c->start = gx_semaphore_label(gx_semaphore_alloc(mem), "memfile compress start");
+    c->done = gx_semaphore_label(gx_semaphore_alloc(mem), "memfile compress done");
+    if (c->start == NULL || c->done == NULL ||
+        gp_thread_start(memfile_compress_thread, c, &c->thread) < 0) {
+        gx_semaphore_free(c->start);
+        gx_semaphore_free(c->done);
+        gs_free_object(mem, c, "memfile_start_compressor");
+        return_error(gs_error_unregistered);
+    }
+    gp_thread_label(c->thread, "memfile compress");
+    f->compressor = c;
+    return 0;
+}
+
+/* Any queued block must have been collected before calling this. */
+static void
+memfile_stop_compressor(MEMFILE * f)
+{
+    MEMFILE_COMPRESSOR *c = f->compressor;
+
+    if (c == NULL)
+        return;
+    c->quit = true;
+    gx_semaphore_signal(c->start);
+    gp_thread_finish(c->thread);
+    gx_semaphore_free(c->start);
+    gx_semaphore_free(c->done);
+    if (c->spare != NULL)
+        FREE(f, c->spare, "memfile_stop_compressor");
+    gs_free_object(c->memory, c, "memfile_stop_compressor");
+    f->compressor = NULL;
+}
+
+/* Append a compressed logical block to the physical block chain. */
+static int
+memfile_append_compressed(MEMFILE * f, LOG_MEMFILE_BLK * bp,
+                          const byte *data, uint size)
+{
+    int ecode = 0;
+    int code;
+    uint count = f->wt.limit - f->wt.ptr;
+    PHYS_MEMFILE_BLK *newphys, *start_phys;
+    char *start_pdata;
+
+    /* The decompressor can only follow a block into one more physical */
+    /* block, so start a new one if this one is full or too short.     */
+    if (count == 0 || size > count + MEMFILE_DATA_SIZE) {
+        newphys =
+            allocateWithReserve(f, sizeof(*newphys), &code, "memfile newphys",
+                        "memfile_append_compressed: MALLOC for 'newphys' failed\n");
+        if (code < 0)
+            return code;
+        ecode |= code;
+        newphys->link = NULL;
+        f->phys_curr->link = newphys;
+        f->phys_curr = newphys;
+        f->wt.ptr = (byte *) (newphys->data) - 1;
+        f->wt.limit = f->wt.ptr + MEMFILE_DATA_SIZE;
+        count = MEMFILE_DATA_SIZE;
+    }
+    start_phys = f->phys_curr;
+    start_pdata = (char *)(f->wt.ptr) + 1;
+    if (count > size)
+        count = size;
+    memcpy(f->wt.ptr + 1, data, count);
+    f->wt.ptr += count;
+    f->phys_curr->data_limit = (char *)(f->wt.ptr);
+    if (count < size) {
+        newphys =
+            allocateWithReserve(f, sizeof(*newphys), &code, "memfile newphys",
+                        "memfile_append_compressed: MALLOC for 'newphys' failed\n");
+        if (code < 0)
+            return code;
+        ecode |= code;
+        newphys->link = NULL;
+        f->phys_curr->link = newphys;
+        f->phys_curr = newphys;
+        f->wt.ptr = (byte *) (newphys->data) - 1;
+        f->wt.limit = f->wt.ptr + MEMFILE_DATA_SIZE;
+        memcpy(f->wt.ptr + 1, data + count, size - count);
+        f->wt.ptr += size - count;
+        newphys->data_limit = (char *)(f->wt.ptr);
+    }
+    bp->phys_blk = start_phys;
+    bp->phys_pdata = start_pdata;
+#ifdef DEBUG
+    tot_compressed += size;
+#endif
+    return ecode;
+}
+
+/* Wait for the block (if any) queued on the compressor thread, and add */
+/* it to the file. The raw block it used is kept for re-use.            */
+static int      /* ret 0 ok, -ve error, or +ve low-memory warning */
+memfile_collect_compressed(MEMFILE * f)
+{
+    MEMFILE_COMPRESSOR *c = f->compressor;
+    LOG_MEMFILE_BLK *bp;
+    int code;
+
+    if (c == NULL || c->bp == NULL)
+        return 0;
+    gx_semaphore_wait(c->done);
+    bp = c->bp;
+    c->bp = NULL;
+    /* On failure bp keeps its raw block, which is still valid data */
+    if (c->status < 0)
+        return_error(gs_error_ioerror);
+    if (c->status != 0) {
+        /* As in compress_log_blk, more than 2 blocks never happens. */
+        emprintf(f->memory,
+                 "Compression required more than one full block!\n");
+        return_error(gs_error_Fatal);
+    }
+    code = memfile_append_compressed(f, bp, c->data, c->size);
+    if (code < 0)
+        return code;
+    if (c->spare == NULL)
+        c->spare = c->raw;
+    else
+        FREE(f, c->raw, "memfile_collect_compressed");
+    c->raw = NULL;
+    return code;
+}
+
 /*      Internal (private) routine to handle end of logical block       */
 static int      /* ret 0 ok, -ve error, or +ve low-memory warning */
 memfile_next_blk(MEMFILE * f)
@@ -758,10 +969,36 @@ memfile_next_blk(MEMFILE * f)
         int code;
 
         oldphys = bp->phys_blk; /* save raw phys block ID               */
-        /* compresses bp on phys list  */
-        if ((code = compress_log_blk(f, bp)) < 0)
-            return code;
-        ecode |= code;
+        if (f->compress_in_background && f->compressor == NULL &&
+            memfile_start_compressor(f) < 0)
+            f->compress_in_background = false;  /* no threads, do it here */
+        if (f->compressor != NULL) {
+            /* Collect the previous block, and queue this one. Fill a   */
+            /* different raw block while the compressor thread works.   */
+            if ((code = memfile_collect_compressed(f)) < 0)
+                return code;
+            ecode |= code;
+            f->compressor->bp = bp;
+            f->compressor->raw = oldphys;
+            gx_semaphore_signal(f->compressor->start);
+            oldphys = f->compressor->spare;
+            f->compressor->spare = NULL;
+            if (oldphys == NULL) {
+                oldphys =
+                    allocateWithReserve(f, sizeof(*oldphys), &code, "memfile newphys",
+                        "memfile_next_blk: MALLOC 3 for 'newphys' failed\n");
+                if (code < 0)
+                    return code;
+                ecode |= code;
+                oldphys->link = NULL;
+                oldphys->data_limit = NULL;     /* raw                  */
+            }
+        } else {
+            /* compresses bp on phys list  */
+            if ((code = compress_log_blk(f, bp)) < 0)
+                return code;
+            ecode |= code;
+        }
         newbp =
             allocateWithReserve(f, sizeof(*newbp), &code, "memfile newbp",
                         "memfile_next_blk: MALLOC 2 for 'newbp' failed\n");
@@ -1008,7 +1245,12 @@ memfile_fread_chars(void *data, uint len, clist_file_ptr cf)
     MEMFILE *f = (MEMFILE *) cf;
     uint count = len, move_count;
     int64_t num_read;
+    int code;
 
+    if ((code = memfile_collect_compressed(f)) < 0) {
+        f->error_code = code;
+        return 0;
+    }
     num_read = f->log_length - f->log_curr_pos;
     if ((int64_t)count > num_read)
         count = (int)num_read;
@@ -1051,7 +1293,12 @@ static int
 memfile_rewind(clist_file_ptr cf, bool discard_data, const char *ignore_fname)
 {
     MEMFILE *f = (MEMFILE *) cf;
+    int code;
 
+    if ((code = memfile_collect_compressed(f)) < 0) {
+        f->error_code = code;
+        return code;
+    }
     if (discard_data) {
         /* This affects the memfile data, not just the MEMFILE * access struct */
         /* Check first to make sure that we have exclusive access */
@@ -1080,6 +1327,9 @@ memfile_fseek(clist_file_ptr cf, int64_t offset, int mode, const char *ignore_fn
     MEMFILE *f = (MEMFILE *) cf;
     int64_t i, block_num, new_pos;
 
+    if (memfile_collect_compressed(f) < 0)
+        return -1;
+
     switch (mode) {
         case SEEK_SET:          /* offset from the beginning of the file */
             new_pos = offset;
@@ -1149,6 +1399,15 @@ memfile_free_mem(MEMFILE * f)
     tot_swap_out = 0;
 #endif
 
+    /* Wait for the compressor thread, and free its spare raw block   */
+    if (f->compressor != NULL) {
+        (void)memfile_collect_compressed(f);
+        if (f->compressor->spare != NULL) {
+            FREE(f, f->compressor->spare, "memfile_free_mem(spare)");
+            f->compressor->spare = NULL;
+        }
+    }
+
     /* Free up memory that was allocated for the memfile              */
     bp = f->log_head;
 
@@ -118,6 +118,9 @@ struct MEMFILE_s {
     stream_cursor_read rd;	/* use .ptr, .limit */			/******* READER INSTANCE *******/
     stream_cursor_write wt;	/* use .ptr, .limit */			/******* READER INSTANCE *******/
     bool compressor_initialized;
+    bool compress_eagerly;	/* compress every block as soon as it is full */
+    bool compress_in_background;	/* ... on the compressor thread if possible */
+    struct MEMFILE_COMPRESSOR_s *compressor;	/* compressor thread, or NULL */
     stream_state *compress_state;
     stream_state *decompress_state;					/******* READER INSTANCE *******/
 };
@@ -138,5 +141,7 @@ const stream_template *clist_compressor_template(void);
 const stream_template *clist_decompressor_template(void);
 void clist_compressor_init(stream_state *state);
 void clist_decompressor_init(stream_state *state);
+/* Select the fastest setting of an initialised (but not yet opened) compressor. */
+void clist_compressor_set_fast(stream_state *state);
 
 #endif /* gxclmem_INCLUDED */
@@ -31,6 +31,7 @@
 #include "gdevp14.h"
 #include "gsmemory.h"
 #include "gsicc_cache.h"
+#include "gxstats.h"
 /*
  * We really don't like the fact that gdevprn.h is included here, since
  * command lists are supposed to be usable for purposes other than printer
@@ -922,7 +923,9 @@ clist_render_rectangle(gx_device_clist *cldev, const gs_int_rect *prect,
     int code = 0;
     int i;
     bool save_pageneutralcolor;
+    gx_stats_clock t;
 
+    gx_stats_begin(bdev->memory, t);
     if (render_plane)
         crdev->yplane = *render_plane;
     else
@@ -999,6 +1002,7 @@ clist_render_rectangle(gx_device_clist *cldev, const gs_int_rect *prect,
                                          prect->p.y);
     }
     crdev->icc_struct->pageneutralcolor = save_pageneutralcolor;	/* restore it */
+    gx_stats_band(bdev->memory, band_first, t);
     return code;
 }
 
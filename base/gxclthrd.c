@@ -38,8 +38,14 @@
 #include "gstrans.h"
 #include "gzht.h"		/* for gx_ht_cache_default_bits_size */
 
+/* Number of reorder buffer slots per rendering thread. With more slots   */
+/* than threads, idle threads can keep working on later bands while the   */
+/* main thread is waiting for an expensive one.                           */
+#define CLIST_BAND_SLOTS_PER_THREAD 2
+
 /* Forward reference prototypes */
-static int clist_start_render_thread(gx_device *dev, int thread_index, int band);
+static int clist_start_render_threads(gx_device *dev, int band);
+static void clist_stop_render_threads(gx_device *dev);
 static void clist_render_thread(void *param);
 
 /* clone a device and set params and its chunk memory                   */
@@ -241,10 +247,18 @@ setup_device_and_mem_for_thread(gs_memory_t *chunk_base_mem, gx_device *dev, boo
     /* The threads are maintained until clist_finish_page.  At which
        point, the threads are torn down, the master clist reader device
        is changed to writer, and the icc_table and the icc_cache_cl freed */
-    if (dev->icc_struct == ndev->icc_struct) {
-    /* safe to share the link cache */
-        ncdev->icc_cache_cl = cdev->icc_cache_cl;
-        rc_increment(cdev->icc_cache_cl);		/* FIXME: needs to be incdemented safely */
+    /* The links in the cache are keyed on the profile hashes, which are the
+       same for cloned profiles, so even when the icc_struct cannot be shared
+       (background printing, or OI_PROFILE) we can share the parent device's
+       link cache, so long as the CMM is thread safe. This includes the
+       background printing thread, whose own rendering threads will then
+       pick up the same cache from it. Each link is then only built once,
+       rather than once per thread. */
+    if (gscms_is_threadsafe()) {
+        if (cdev->icc_cache_cl == NULL &&
+            (cdev->icc_cache_cl = gsicc_cache_new(cdev->memory->thread_safe_memory)) == NULL)
+            goto out_cleanup;
+        ncdev->icc_cache_cl = gsicc_cache_addref(cdev->icc_cache_cl);
     } else {
         /* each thread needs its own link cache */
         if (cachep != NULL) {
@@ -303,6 +317,60 @@ out_cleanup:
     return NULL;
 }
 
+/* Allocate the reorder buffer the render threads park finished bands in, */
+/* and the lock and semaphores controlling it.                            */
+static int
+clist_setup_band_slots(gx_device *dev, gx_process_page_options_t *options)
+{
+    gx_device_clist *cldev = (gx_device_clist *)dev;
+    gx_device_clist_common *cdev = (gx_device_clist_common *)cldev;
+    gx_device_clist_reader *crdev = &cldev->reader;
+    gs_memory_t *mem = cdev->bandlist_memory->thread_safe_memory;
+    int band_height = crdev->page_info.band_params.BandHeight;
+    size_t data_size = cdev->data_size;
+    int i, num_slots, code;
+
+    /* The data areas are swapped between the slots, the threads and the */
+    /* main device, so they must all be as large as the largest of them. */
+    for (i = 0; i < crdev->num_render_threads; i++) {
+        gx_device_clist_common *thread_cdev = (gx_device_clist_common *)crdev->render_threads[i].cdev;
+
+        if (thread_cdev->data_size > data_size)
+            data_size = thread_cdev->data_size;
+    }
+    num_slots = crdev->num_render_threads * CLIST_BAND_SLOTS_PER_THREAD;
+    if (num_slots > cdev->nbands)
+        num_slots = cdev->nbands;
+
+    crdev->band_lock = gx_monitor_label(gx_monitor_alloc(mem), "Band slots");
+    crdev->band_slots = (clist_band_slot_t *)gs_alloc_byte_array(mem, num_slots,
+                                    sizeof(clist_band_slot_t), "clist_setup_band_slots");
+    if (crdev->band_lock == NULL || crdev->band_slots == NULL)
+        return_error(gs_error_VMerror);
+    memset(crdev->band_slots, 0, num_slots * sizeof(clist_band_slot_t));
+
+    for (i = 0; i < num_slots; i++) {
+        clist_band_slot_t *slot = &(crdev->band_slots[i]);
+
+        slot->alloc_data = gs_alloc_bytes(mem, data_size, "clist_setup_band_slots");
+        if (slot->alloc_data == NULL)
+            break;
+        slot->data = slot->alloc_data;
+        slot->band = -1;
+        slot->status = THREAD_IDLE;
+        crdev->num_band_slots = i + 1;
+        if (options && options->init_buffer_fn) {
+            code = options->init_buffer_fn(options->arg, dev, mem, dev->width, band_height, &slot->buffer);
+            if (code < 0)
+                return code;
+        }
+    }
+    /* A shallower reorder buffer still works, as long as there is one slot */
+    if (crdev->num_band_slots == 0)
+        return_error(gs_error_VMerror);
+    return 0;
+}
+
 /* Set up and start the render threads */
 static int
 clist_setup_render_threads(gx_device *dev, int y, gx_process_page_options_t *options)
@@ -314,7 +382,7 @@ clist_setup_render_threads(gx_device *dev, int y, gx_process_page_options_t *opt
     gs_memory_t *mem = cdev->bandlist_memory;
     gs_memory_t *chunk_base_mem = mem->thread_safe_memory;
     gs_memory_status_t mem_status;
-    int i, j, band;
+    int i, j, band, first_band;
     int code = 0;
     int band_count = cdev->nbands;
     int band_height = crdev->page_info.band_params.BandHeight;
@@ -374,10 +442,14 @@ clist_setup_render_threads(gx_device *dev, int y, gx_process_page_options_t *opt
             sizeof(clist_render_thread_control_t));
 
     crdev->main_thread_data = cdev->data;               /* save data area */
+    crdev->num_band_slots = 0;
+    crdev->band_slots = NULL;
+    crdev->band_lock = NULL;
+    crdev->band_slots_free = crdev->band_done = NULL;
     /* Based on the line number requested, decide the order of band rendering */
     /* Almost all devices go in increasing line order (except the bmp* devices ) */
     crdev->thread_lookahead_direction = (y < (cdev->height - 1)) ? 1 : -1;
-    band = y / band_height;
+    band = first_band = y / band_height;
 
     /* If the 'mem' is not thread safe, we need to wrap it in a locking memory */
     gs_memory_status(chunk_base_mem, &mem_status);
@@ -385,8 +457,10 @@ clist_setup_render_threads(gx_device *dev, int y, gx_process_page_options_t *opt
             return_error(gs_error_VMerror);
     }
 
-    /* If we don't have one large enough already, create an icc cache list */
-    if (crdev->num_render_threads > crdev->icc_cache_list_len) {
+    /* If the CMM isn't thread safe each thread needs its own link cache. If */
+    /* we don't have one large enough already, create an icc cache list.     */
+    /* Otherwise the threads all share the device's link cache.              */
+    if (!gscms_is_threadsafe() && crdev->num_render_threads > crdev->icc_cache_list_len) {
         gsicc_link_cache_t **old = crdev->icc_cache_list;
         crdev->icc_cache_list = (gsicc_link_cache_t **)gs_alloc_byte_array(mem->thread_safe_memory,
                                     crdev->num_render_threads,
@@ -417,7 +491,8 @@ clist_setup_render_threads(gx_device *dev, int y, gx_process_page_options_t *opt
             code = gs_error_VMerror;	/* set code to an error for cleanup after the loop */
         break;
         }
-        ndev = setup_device_and_mem_for_thread(chunk_base_mem, dev, false, &crdev->icc_cache_list[i]);
+        ndev = setup_device_and_mem_for_thread(chunk_base_mem, dev, false,
+                        crdev->icc_cache_list == NULL ? NULL : &crdev->icc_cache_list[i]);
         if (ndev == NULL) {
             code = gs_error_VMerror;	/* set code to an error for cleanup after the loop */
             break;
@@ -425,11 +500,14 @@ clist_setup_render_threads(gx_device *dev, int y, gx_process_page_options_t *opt
 
         thread->cdev = ndev;
         thread->memory = ndev->memory;
+        thread->main_dev = dev;
         thread->band = -1;              /* a value that won't match any valid band */
         thread->options = options;
         thread->buffer = NULL;
+        /* The buffers move between threads along with the bands, so they */
+        /* come from the thread safe allocator rather than the thread's.  */
         if (options && options->init_buffer_fn) {
-            code = options->init_buffer_fn(options->arg, dev, thread->memory, dev->width, band_height, &thread->buffer);
+            code = options->init_buffer_fn(options->arg, dev, chunk_base_mem, dev->width, band_height, &thread->buffer);
             if (code < 0)
                 break;
         }
@@ -447,7 +525,6 @@ clist_setup_render_threads(gx_device *dev, int y, gx_process_page_options_t *opt
         }
         /* We don't start the threads yet until we  free up the */
         /* reserve memory we have allocated for that band. */
-        thread->band = band;
     }
     /* If the code < 0, the last thread creation failed -- clean it up */
     if (code < 0) {
@@ -470,7 +547,7 @@ clist_setup_render_threads(gx_device *dev, int y, gx_process_page_options_t *opt
             "clist_setup_render_threads");
         }
         if (crdev->render_threads[i].buffer != NULL && options && options->free_buffer_fn != NULL) {
-            options->free_buffer_fn(options->arg, dev, crdev->render_threads[i].memory, crdev->render_threads[i].buffer);
+            options->free_buffer_fn(options->arg, dev, chunk_base_mem, crdev->render_threads[i].buffer);
             crdev->render_threads[i].buffer = NULL;
         }
         if (crdev->render_threads[i].memory != NULL) {
@@ -510,18 +587,22 @@ clist_setup_render_threads(gx_device *dev, int y, gx_process_page_options_t *opt
      * threads since we deferred that in the thread setup loop above.
      * We know if we get here we can start at least 1 thread.
      */
-    for (j=0, code = 0; j<crdev->num_render_threads; j++) {
+    for (j=0; j<crdev->num_render_threads; j++)
         gs_free_object(mem, reserve_memory_array[j], "clist_setup_render_threads");
-        if (code == 0 && j < i)
-            code = clist_start_render_thread(dev, j, crdev->render_threads[j].band);
-    }
     gs_free_object(mem, reserve_memory_array, "clist_setup_render_threads");
     crdev->num_render_threads = i;
-    crdev->curr_render_thread = 0;
-    crdev->next_band = band;
+
+    code = clist_setup_band_slots(dev, options);
+    if (code >= 0)
+        code = clist_start_render_threads(dev, first_band);
+    if (code < 0) {
+        clist_teardown_render_threads(dev);
+        emprintf1(mem, "Rendering threads not started, code=%d.\n", code);
+        return code;
+    }
 
     if(gs_debug[':'] != 0)
-        dmprintf1(mem, "%% Using %d rendering threads\n", i);
+        dmprintf2(mem, "%% Using %d rendering threads, %d band slots\n", i, crdev->num_band_slots);
 
     return code;
 }
@@ -556,7 +637,7 @@ teardown_device_and_mem_for_thread(gx_device *dev, gp_thread_id thread_id, bool
          */
         thread_crdev->icc_table = NULL;
     }
-    rc_decrement(thread_crdev->icc_cache_cl, "teardown_render_thread");
+    gsicc_cache_release(thread_crdev->icc_cache_cl, "teardown_render_thread");
     thread_crdev->icc_cache_cl = NULL;
     /*
      * Free the BufferSpace, close the band files, optionally unlinking them.
@@ -596,16 +677,14 @@ clist_teardown_render_threads(gx_device *dev)
     gx_device_clist_common *cdev = (gx_device_clist_common *)dev;
     gx_device_clist_reader *crdev = &cldev->reader;
     gs_memory_t *mem = cdev->bandlist_memory;
+    gs_memory_t *chunk_base_mem = mem->thread_safe_memory;
+    gx_process_page_options_t *options;
     int i;
 
     if (crdev->render_threads != NULL) {
+        options = crdev->render_threads[0].options;
         /* Wait for all threads to finish */
-        for (i = (crdev->num_render_threads - 1); i >= 0; i--) {
-            clist_render_thread_control_t *thread = &(crdev->render_threads[i]);
-
-            if (thread->status == THREAD_BUSY)
-                gx_semaphore_wait(thread->sema_this);
-        }
+        clist_stop_render_threads(dev);
         /* then free each thread's memory */
         for (i = (crdev->num_render_threads - 1); i >= 0; i--) {
             clist_render_thread_control_t *thread = &(crdev->render_threads[i]);
@@ -619,17 +698,11 @@ clist_teardown_render_threads(gx_device *dev)
 
             if (thread->options) {
                 if (thread->options->free_buffer_fn && thread->buffer) {
-                    thread->options->free_buffer_fn(thread->options->arg, dev, thread->memory, thread->buffer);
+                    thread->options->free_buffer_fn(thread->options->arg, dev, chunk_base_mem, thread->buffer);
                     thread->buffer = NULL;
                 }
                 thread->options = NULL;
             }
-
-            /* before freeing this device's memory, swap with cdev if it was the main_thread_data */
-            if (thread_cdev->data == crdev->main_thread_data) {
-                thread_cdev->data = cdev->data;
-                cdev->data = crdev->main_thread_data;
-            }
 #ifdef DEBUG
             if (gs_debug[':'])
                 dmprintf2(thread->memory, "%% Thread %d total usertime=%ld msec\n", i, thread->cputime);
@@ -640,6 +713,26 @@ clist_teardown_render_threads(gx_device *dev)
         gs_free_object(mem, crdev->render_threads, "clist_teardown_render_threads");
         crdev->render_threads = NULL;
 
+        /* Free the reorder buffer. The data areas have been passed around */
+        /* so the main device gets its own back, and each slot frees the   */
+        /* one allocated for it, wherever that ended up.                   */
+        cdev->data = crdev->main_thread_data;
+        for (i = 0; i < crdev->num_band_slots; i++) {
+            clist_band_slot_t *slot = &(crdev->band_slots[i]);
+
+            if (options && options->free_buffer_fn && slot->buffer)
+                options->free_buffer_fn(options->arg, dev, chunk_base_mem, slot->buffer);
+            gs_free_object(chunk_base_mem, slot->alloc_data, "clist_teardown_render_threads");
+        }
+        gs_free_object(chunk_base_mem, crdev->band_slots, "clist_teardown_render_threads");
+        crdev->band_slots = NULL;
+        crdev->num_band_slots = 0;
+        gx_semaphore_free(crdev->band_slots_free);
+        gx_semaphore_free(crdev->band_done);
+        crdev->band_slots_free = crdev->band_done = NULL;
+        gx_monitor_free(crdev->band_lock);
+        crdev->band_lock = NULL;
+
         /* Now re-open the clist temp files so we can write to them */
         if (cdev->page_info.cfile == NULL) {
             char fmode[4];
@@ -656,29 +749,80 @@ clist_teardown_render_threads(gx_device *dev)
     }
 }
 
+/* (Re)start the render threads, claiming bands from 'band' onwards in the */
+/* lookahead direction. Anything left in the reorder buffer is discarded.  */
 static int
-clist_start_render_thread(gx_device *dev, int thread_index, int band)
+clist_start_render_threads(gx_device *dev, int band)
 {
     gx_device_clist *cldev = (gx_device_clist *)dev;
     gx_device_clist_reader *crdev = &cldev->reader;
-    int code;
+    gs_memory_t *mem = crdev->bandlist_memory->thread_safe_memory;
+    int i, code = 0;
 
-    crdev->render_threads[thread_index].band = band;
-    crdev->render_threads[thread_index].status = THREAD_BUSY;
+    crdev->next_band = crdev->next_band_out = band;
+    crdev->render_threads_stop = false;
+    for (i = 0; i < crdev->num_band_slots; i++) {
+        crdev->band_slots[i].status = THREAD_IDLE;
+        crdev->band_slots[i].band = -1;
+    }
+    /* Use fresh semaphores so no stale counts survive a restart */
+    gx_semaphore_free(crdev->band_slots_free);
+    gx_semaphore_free(crdev->band_done);
+    crdev->band_slots_free = gx_semaphore_label(gx_semaphore_alloc(mem), "Band slots free");
+    crdev->band_done = gx_semaphore_label(gx_semaphore_alloc(mem), "Band done");
+    if (crdev->band_slots_free == NULL || crdev->band_done == NULL)
+        return_error(gs_error_VMerror);
+    for (i = 0; i < crdev->num_band_slots; i++)
+        gx_semaphore_signal(crdev->band_slots_free);
 
-    /* Finally, fire it up */
-    code = gp_thread_start(clist_render_thread,
-                           &(crdev->render_threads[thread_index]),
-                           &(crdev->render_threads[thread_index].thread));
-    gp_thread_label(crdev->render_threads[thread_index].thread, "Band");
+    /* Finally, fire them up */
+    for (i = 0; i < crdev->num_render_threads; i++) {
+        clist_render_thread_control_t *thread = &(crdev->render_threads[i]);
 
+        thread->band = -1;
+        thread->status = THREAD_BUSY;
+        code = gp_thread_start(clist_render_thread, thread, &(thread->thread));
+        if (code < 0) {
+            thread->status = THREAD_IDLE;
+            break;
+        }
+        gp_thread_label(thread->thread, "Band");
+    }
     return code;
 }
 
+/* Tell the render threads to stop claiming bands, and wait for them all */
+/* to exit. Threads in the middle of a band finish it first.             */
 static void
-clist_render_thread(void *data)
+clist_stop_render_threads(gx_device *dev)
+{
+    gx_device_clist *cldev = (gx_device_clist *)dev;
+    gx_device_clist_reader *crdev = &cldev->reader;
+    int i;
+
+    if (crdev->band_lock != NULL) {
+        gx_monitor_enter(crdev->band_lock);
+        crdev->render_threads_stop = true;
+        gx_monitor_leave(crdev->band_lock);
+    }
+    /* Wake any thread waiting for a free slot so it sees the stop request */
+    if (crdev->band_slots_free != NULL)
+        for (i = 0; i < crdev->num_render_threads; i++)
+            gx_semaphore_signal(crdev->band_slots_free);
+    for (i = 0; i < crdev->num_render_threads; i++) {
+        clist_render_thread_control_t *thread = &(crdev->render_threads[i]);
+
+        if (thread->status == THREAD_BUSY)
+            gx_semaphore_wait(thread->sema_this);
+        gp_thread_finish(thread->thread);
+        thread->thread = NULL;
+    }
+}
+
+/* Render one band into the thread's current data area */
+static int
+clist_render_thread_band(clist_render_thread_control_t *thread, int band)
 {
-    clist_render_thread_control_t *thread = (clist_render_thread_control_t *)data;
     gx_device *dev = thread->cdev;
     gx_device_clist *cldev = (gx_device_clist *)dev;
     gx_device_clist_reader *crdev = &cldev->reader;
@@ -689,14 +833,13 @@ clist_render_thread(void *data)
     uint raster = gx_device_raster_plane(dev, NULL);
     int code;
     int band_height = crdev->page_info.band_params.BandHeight;
-    int band = thread->band;
     int band_begin_line = band * band_height;
     int band_end_line = band_begin_line + band_height;
     int band_num_lines;
 #ifdef DEBUG
     long starttime[2], endtime[2];
 
-    gp_get_usertime(starttime); /* thread start time */
+    gp_get_usertime(starttime); /* band start time */
 #endif
     if (band_end_line > dev->height)
         band_end_line = dev->height;
@@ -718,16 +861,77 @@ clist_render_thread(void *data)
     crdev->ymin = band_begin_line;
     crdev->ymax = band_end_line;
     crdev->offset_map = NULL;
-    if (code < 0)
-        thread->status = THREAD_ERROR;          /* shouldn't happen */
-    else
-        thread->status = THREAD_DONE;    /* OK */
 
 #ifdef DEBUG
     gp_get_usertime(endtime);
     thread->cputime += (endtime[0] - starttime[0]) * 1000 +
              (endtime[1] - starttime[1]) / 1000000;
 #endif
+    return code;
+}
+
+/*
+ * Each render thread loops taking the next unrendered band (in lookahead
+ * order) whenever there is a free slot in the reorder buffer, so an idle
+ * thread never waits for a slow band on another thread. The finished band
+ * is parked in the slot, swapping data areas so the thread carries on with
+ * the slot's old one, until the main thread consumes it in band order.
+ */
+static void
+clist_render_thread(void *data)
+{
+    clist_render_thread_control_t *thread = (clist_render_thread_control_t *)data;
+    gx_device_clist *cldev = (gx_device_clist *)thread->cdev;
+    gx_device_clist_reader *crdev = &cldev->reader;
+    gx_device_clist_reader *main_crdev = &((gx_device_clist *)thread->main_dev)->reader;
+    int band_count = main_crdev->nbands;
+    clist_band_slot_t *slot;
+    int i, band, code;
+    byte *tmp;                  /* for swapping data areas */
+    void *tmp_buffer;
+
+    for (;;) {
+        /* Wait for room in the reorder buffer, then claim the next band */
+        gx_semaphore_wait(main_crdev->band_slots_free);
+        gx_monitor_enter(main_crdev->band_lock);
+        band = main_crdev->next_band;
+        if (main_crdev->render_threads_stop || band < 0 || band >= band_count) {
+            gx_monitor_leave(main_crdev->band_lock);
+            /* Pass the wakeup on to any other thread waiting for a slot */
+            gx_semaphore_signal(main_crdev->band_slots_free);
+            break;
+        }
+        main_crdev->next_band += main_crdev->thread_lookahead_direction;
+        /* The semaphore guarantees that there is a free slot */
+        for (i = 0; main_crdev->band_slots[i].status != THREAD_IDLE; i++)
+            ;
+        slot = &(main_crdev->band_slots[i]);
+        slot->status = THREAD_BUSY;
+        slot->band = band;
+        thread->band = band;
+        gx_monitor_leave(main_crdev->band_lock);
+
+        code = clist_render_thread_band(thread, band);
+
+        /* Park the band in the slot, and take the slot's data area and */
+        /* buffer for the next band we render.                          */
+        gx_monitor_enter(main_crdev->band_lock);
+        tmp = crdev->data;
+        crdev->data = slot->data;
+        slot->data = tmp;
+        tmp_buffer = thread->buffer;
+        thread->buffer = slot->buffer;
+        slot->buffer = tmp_buffer;
+        if (code < 0) {
+            slot->status = THREAD_ERROR;          /* shouldn't happen */
+            main_crdev->render_threads_stop = true;
+        } else
+            slot->status = THREAD_DONE;    /* OK */
+        thread->band = -1;
+        gx_monitor_leave(main_crdev->band_lock);
+        gx_semaphore_signal(main_crdev->band_done);
+    }
+    thread->status = THREAD_DONE;
     /*
      * Signal the semaphores. We signal the 'group' first since even if
      * the waiter is released on the group, it still needs to check
@@ -738,12 +942,12 @@ clist_render_thread(void *data)
 }
 
 /*
- * Copy the raster data from the completed thread to the caller's
- * device (the main thread)
+ * Take the completed band from the reorder buffer for the caller's
+ * device (the main thread), waiting for it to be rendered if needed.
  * Return 0 if OK, < 0 is the error code from the thread
  *
- * After swapping the pointers, start up the completed thread with the
- * next band remaining to do (if any)
+ * The data areas are swapped to avoid a copy, and the slot is then
+ * handed back to the render threads for the next band remaining (if any)
  */
 static int
 clist_get_band_from_thread(gx_device *dev, int band_needed, gx_process_page_options_t *options)
@@ -752,85 +956,76 @@ clist_get_band_from_thread(gx_device *dev, int band_needed, gx_process_page_opti
     gx_device_clist_common *cdev = (gx_device_clist_common *)dev;
     gx_device_clist_reader *crdev = &cldev->reader;
     int i, code = 0;
-    int thread_index = crdev->curr_render_thread;
-    clist_render_thread_control_t *thread = &(crdev->render_threads[thread_index]);
-    gx_device_clist_common *thread_cdev = (gx_device_clist_common *)thread->cdev;
+    clist_band_slot_t *slot = NULL;
     int band_height = crdev->page_info.band_params.BandHeight;
     int band_count = cdev->nbands;
     byte *tmp;                  /* for swapping data areas */
 
-    /* We expect that the thread needed will be the 'current' thread */
-    if (thread->band != band_needed) {
-        int band = band_needed;
-
-        emprintf3(thread->memory,
-                  "thread->band = %d, band_needed = %d, direction = %d, ",
-                  thread->band, band_needed, crdev->thread_lookahead_direction);
-
-        /* Probably we went in the wrong direction, so let the threads */
-        /* all complete, then restart them in the opposite direction   */
-        /* If the caller is 'bouncing around' we may end up back here, */
-        /* but that is a VERY rare case (we haven't seen it yet).      */
-        for (i=0; i < crdev->num_render_threads; i++) {
-            clist_render_thread_control_t *thread = &(crdev->render_threads[i]);
-
-            if (thread->status == THREAD_BUSY)
-                gx_semaphore_wait(thread->sema_this);
-        }
+    /* We expect the bands to be asked for in lookahead order */
+    if (band_needed != crdev->next_band_out) {
+        emprintf3(cdev->memory,
+                  "next_band_out = %d, band_needed = %d, direction = %d, ",
+                  crdev->next_band_out, band_needed, crdev->thread_lookahead_direction);
+
+        /* Probably we went in the wrong direction, so stop the threads, */
+        /* then restart them in the opposite direction, discarding what  */
+        /* they had rendered. If the caller is 'bouncing around' we may  */
+        /* end up back here, but that is a VERY rare case (we haven't    */
+        /* seen it yet).                                                 */
+        clist_stop_render_threads(dev);
         crdev->thread_lookahead_direction *= -1;      /* reverse direction (but may be overruled below) */
         if (band_needed == band_count-1)
             crdev->thread_lookahead_direction = -1;   /* assume backwards if we are asking for the last band */
         if (band_needed == 0)
             crdev->thread_lookahead_direction = 1;    /* force forward if we are looking for band 0 */
 
-        dmprintf1(thread->memory, "new_direction = %d\n", crdev->thread_lookahead_direction);
+        dmprintf1(cdev->memory, "new_direction = %d\n", crdev->thread_lookahead_direction);
 
-        /* Loop starting the threads in the new lookahead_direction */
-        for (i=0; (i < crdev->num_render_threads) && (band >= 0) && (band < band_count);
-                i++, band += crdev->thread_lookahead_direction) {
-            thread = &(crdev->render_threads[i]);
-            thread->band = -1;          /* a value that won't match any valid band */
-            /* Start thread 'i' to do band */
-            if ((code = clist_start_render_thread(dev, i, band)) < 0)
+        if ((code = clist_start_render_threads(dev, band_needed)) < 0)
+            return code;
+    }
+    /* Wait for the band to turn up in the reorder buffer */
+    for (;;) {
+        gx_monitor_enter(crdev->band_lock);
+        for (i = 0; i < crdev->num_band_slots; i++) {
+            if (crdev->band_slots[i].band == band_needed &&
+                (crdev->band_slots[i].status == THREAD_DONE ||
+                 crdev->band_slots[i].status == THREAD_ERROR)) {
+                slot = &(crdev->band_slots[i]);
                 break;
+            }
         }
-        crdev->next_band = i;			/* may be < 0 or == band_count, but that is handled later */
-        crdev->curr_render_thread = thread_index = 0;
-        thread = &(crdev->render_threads[0]);
-        thread_cdev = (gx_device_clist_common *)thread->cdev;
+        gx_monitor_leave(crdev->band_lock);
+        if (slot != NULL)
+            break;
+        gx_semaphore_wait(crdev->band_done);
     }
-    /* Wait for this thread */
-    gx_semaphore_wait(thread->sema_this);
-    gp_thread_finish(thread->thread);
-    thread->thread = NULL;
-    if (thread->status == THREAD_ERROR)
+    if (slot->status == THREAD_ERROR)
         return_error(gs_error_unknownerror);          /* FAIL */
 
     if (options && options->output_fn) {
-        code = options->output_fn(options->arg, dev, thread->buffer);
+        code = options->output_fn(options->arg, dev, slot->buffer);
         if (code < 0)
             return code;
     }
 
     /* Swap the data areas to avoid the copy */
     tmp = cdev->data;
-    cdev->data = thread_cdev->data;
-    thread_cdev->data = tmp;
-    thread->status = THREAD_IDLE;        /* the data is no longer valid */
-    thread->band = -1;
+    cdev->data = slot->data;
+    slot->data = tmp;
     /* Update the bounds for this band */
     cdev->ymin =  band_needed * band_height;
     cdev->ymax =  cdev->ymin + band_height;
     if (cdev->ymax > dev->height)
         cdev->ymax = dev->height;
-
-    if (crdev->next_band >= 0 && crdev->next_band < band_count) {
-        code = clist_start_render_thread(dev, thread_index, crdev->next_band);
-        crdev->next_band += crdev->thread_lookahead_direction;
-    }
-    /* bump the 'curr' to the next thread */
-    crdev->curr_render_thread = crdev->curr_render_thread == crdev->num_render_threads - 1 ?
-                0 : crdev->curr_render_thread + 1;
+    crdev->next_band_out = band_needed + crdev->thread_lookahead_direction;
+
+    /* The data is no longer valid, so hand the slot back to the threads */
+    gx_monitor_enter(crdev->band_lock);
+    slot->status = THREAD_IDLE;
+    slot->band = -1;
+    gx_monitor_leave(crdev->band_lock);
+    gx_semaphore_signal(crdev->band_slots_free);
 
     return code;
 }
@@ -54,7 +54,8 @@ struct clist_render_thread_control_s {
     gx_semaphore_t *sema_group;
     gx_device *cdev;	/* clist device copy */
     gx_device *bdev;	/* this thread's buffer device */
-    int band;
+    gx_device *main_dev;	/* device owning the band queue we take work from */
+    int band;		/* band being rendered, -1 when none */
     gp_thread_id thread;
 
     /* For process_page mode */
@@ -65,4 +66,18 @@ struct clist_render_thread_control_s {
 #endif
 };
 
+/* The render threads take bands in lookahead order from a shared counter  */
+/* as soon as they are idle, so one slow band doesn't hold up the others.   */
+/* A completed band is parked in a slot of the reorder buffer until the     */
+/* main thread consumes it; the band data areas (and process_page buffers)  */
+/* are swapped between the thread, the slot and the main device, never      */
+/* copied.                                                                  */
+struct clist_band_slot_s {
+    thread_status status;	/* IDLE: free, BUSY: claimed, DONE/ERROR: rendered */
+    int band;			/* band claimed or held, -1 when free */
+    byte *data;			/* band data area currently held by this slot */
+    void *buffer;		/* process_page buffer currently held by this slot */
+    byte *alloc_data;		/* data area allocated for this slot (for freeing) */
+};
+
 #endif /* gxclthrd_INCLUDED */
@@ -27,6 +27,7 @@
 #include "gxcldev.h"
 #include "gxclpath.h"
 #include "gsparams.h"
+#include "gxstats.h"
 
 #include "valgrind.h"
 #include <limits.h>
@@ -305,12 +306,15 @@ cmd_write_buffer(gx_device_clist_writer * cldev, byte cmd_end)
     int nbands = cldev->nbands;
     gx_clist_state *pcls;
     int band;
-    int code = cmd_write_band(cldev, cldev->band_range_min,
-                              cldev->band_range_max,
-                              cldev->band_range_list,
-                              cmd_opv_end_run);
+    int code, warning;
+    gx_stats_clock t;
 
-    int warning = code;
+    gx_stats_begin(cldev->memory, t);
+    code = cmd_write_band(cldev, cldev->band_range_min,
+                          cldev->band_range_max,
+                          cldev->band_range_list,
+                          cmd_opv_end_run);
+    warning = code;
 
     for (band = 0, pcls = cldev->states;
          code >= 0 && band < nbands; band++, pcls++
@@ -330,6 +334,7 @@ cmd_write_buffer(gx_device_clist_writer * cldev, byte cmd_end)
     if (gs_debug_c('l'))
         cmd_print_stats(cldev->memory);
 #endif
+    gx_stats_end(cldev->memory, gx_stats_clist_write, t);
     return_check_interrupt(cldev->memory, code != 0 ? code : warning);
 }
 
@@ -47,3 +47,8 @@ clist_decompressor_init(stream_state *state)
     ((stream_zlib_state *)state)->no_wrapper = true;
     state->templat = &s_zlibD_template;
 }
+void
+clist_compressor_set_fast(stream_state *state)
+{
+    ((stream_zlib_state *)state)->level = 1;	/* Z_BEST_SPEED */
+}
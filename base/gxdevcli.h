@@ -672,9 +672,21 @@ typedef struct gx_band_params_s {
     int BandHeight;		/* (optional) */
     size_t BandBufferSpace;	/* (optional) */
     size_t tile_cache_size;	/* (optional) */
+    int BandListCompression;	/* (optional) see below */
 } gx_band_params_t;
 
-#define BAND_PARAMS_INITIAL_VALUES 0, 0, 0, 0
+#define BAND_PARAMS_INITIAL_VALUES 0, 0, 0, 0, 0
+
+/*
+ * How an in-memory band list is compressed. By default the blocks are only
+ * compressed once the band list gets very large; BandListCompressFast uses
+ * the fastest setting of the compressor on every block as it is written,
+ * doing the work on a background thread where threads are available.
+ */
+typedef enum {
+    BandListCompressDefault = 0,
+    BandListCompressFast
+} gdev_band_list_compression;
 
 typedef enum {
     BandingAuto = 0,
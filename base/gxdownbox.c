@@ -0,0 +1,364 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  39 Mesa Street, Suite 108A, San Francisco,
+   CA 94129, USA, for further information.
+*/
+
+
+/* Box filter cores for the contone downscaler */
+#include "string_.h"
+#include "stdint_.h"
+#include "gxdownbox.h"
+
+#ifdef HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+/* Set the input pixels from width to awidth to white, in all factor rows.
+ * bpp is the number of bytes per input pixel. */
+static void
+down_pad_white(byte *in_buffer, int span, int width, int awidth, int factor,
+               int bpp)
+{
+    int pad_white = (awidth - width) * factor * bpp;
+    int y;
+
+    if (pad_white <= 0)
+        return;
+
+    in_buffer += width * factor * bpp;
+    for (y = factor; y > 0; y--)
+    {
+        memset(in_buffer, 0xFF, pad_white);
+        in_buffer += span;
+    }
+}
+
+void
+gx_downscale_box8_c(byte *outp, byte *in_buffer, int span, int width,
+                    int awidth, int factor, int nc)
+{
+    int   x, xx, y, c, value;
+    int   div  = factor*factor;
+    int   step = factor*nc;
+    const byte *inp;
+
+    down_pad_white(in_buffer, span, width, awidth, factor, nc);
+
+    for (x = 0; x < awidth; x++)
+    {
+        for (c = 0; c < nc; c++)
+        {
+            inp = in_buffer + x*step + c;
+            value = 0;
+            for (y = factor; y > 0; y--)
+            {
+                for (xx = 0; xx < step; xx += nc)
+                    value += inp[xx];
+                inp += span;
+            }
+            *outp++ = (value+(div>>1))/div;
+        }
+    }
+}
+
+void
+gx_downscale_box16_c(byte *outp, byte *in_buffer, int span, int width,
+                     int awidth, int factor)
+{
+    int   x, xx, y, value;
+    int   div  = factor*factor;
+    int   step = factor*2;
+    const byte *inp;
+
+    down_pad_white(in_buffer, span, width, awidth, factor, 2);
+
+    for (x = 0; x < awidth; x++)
+    {
+        inp = in_buffer + x*step;
+        value = 0;
+        for (y = factor; y > 0; y--)
+        {
+            for (xx = 0; xx < step; xx += 2)
+                value += (inp[xx]<<8) + inp[xx+1];
+            inp += span;
+        }
+        value = (value + (div>>1))/div;
+        outp[0] = value>>8;
+        outp[1] = value;
+        outp += 2;
+    }
+}
+
+#ifdef HAVE_SSE2
+
+/* Number of column sums we process at a time. */
+#define DOWN_SUM_CHUNK 1536
+
+/* Largest factor for which factor rows of bytes sum to 16 bits. */
+#define DOWN_SUM_MAX_FACTOR 257
+
+/* Sum 'factor' rows (span bytes apart) of n bytes into sums. The callers
+ * keep factor to DOWN_SUM_MAX_FACTOR, so the sums always fit in 16 bits. */
+static void
+down_sum_rows(uint16_t *sums, const byte *inp, int span, int factor, int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0, y;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        const byte *p = inp + i;
+        __m128i lo = zero, hi = zero;
+
+        for (y = factor; y > 0; y--)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)p);
+            lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+            hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+            p += span;
+        }
+        _mm_storeu_si128((__m128i *)(sums + i), lo);
+        _mm_storeu_si128((__m128i *)(sums + i + 8), hi);
+    }
+    for (; i < n; i++)
+    {
+        const byte *p = inp + i;
+        int value = 0;
+
+        for (y = factor; y > 0; y--)
+        {
+            value += *p;
+            p += span;
+        }
+        sums[i] = value;
+    }
+}
+
+/* As down_sum_rows, for n big endian 16 bit samples. */
+static void
+down_sum_rows16(uint32_t *sums, const byte *inp, int span, int factor, int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0, y;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        const byte *p = inp + i*2;
+        __m128i lo = zero, hi = zero;
+
+        for (y = factor; y > 0; y--)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)p);
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            lo = _mm_add_epi32(lo, _mm_unpacklo_epi16(v, zero));
+            hi = _mm_add_epi32(hi, _mm_unpackhi_epi16(v, zero));
+            p += span;
+        }
+        _mm_storeu_si128((__m128i *)(sums + i), lo);
+        _mm_storeu_si128((__m128i *)(sums + i + 4), hi);
+    }
+    for (; i < n; i++)
+    {
+        const byte *p = inp + i*2;
+        int value = 0;
+
+        for (y = factor; y > 0; y--)
+        {
+            value += (p[0]<<8) + p[1];
+            p += span;
+        }
+        sums[i] = value;
+    }
+}
+
+/* Grey, factor 2: 16 output pixels at a time. */
+static void
+down_box8_2_sse2(byte *outp, const byte *inp, int span, int awidth)
+{
+    const __m128i even = _mm_set1_epi16(0xff);
+    const __m128i two = _mm_set1_epi16(2);
+    int   x = awidth;
+
+    for (; x >= 16; x -= 16)
+    {
+        __m128i a0 = _mm_loadu_si128((const __m128i *)inp);
+        __m128i a1 = _mm_loadu_si128((const __m128i *)(inp+16));
+        __m128i b0 = _mm_loadu_si128((const __m128i *)(inp+span));
+        __m128i b1 = _mm_loadu_si128((const __m128i *)(inp+span+16));
+        __m128i s0 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a0, even), _mm_srli_epi16(a0, 8)),
+                                   _mm_add_epi16(_mm_and_si128(b0, even), _mm_srli_epi16(b0, 8)));
+        __m128i s1 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a1, even), _mm_srli_epi16(a1, 8)),
+                                   _mm_add_epi16(_mm_and_si128(b1, even), _mm_srli_epi16(b1, 8)));
+
+        s0 = _mm_srli_epi16(_mm_add_epi16(s0, two), 2);
+        s1 = _mm_srli_epi16(_mm_add_epi16(s1, two), 2);
+        _mm_storeu_si128((__m128i *)outp, _mm_packus_epi16(s0, s1));
+        inp += 32;
+        outp += 16;
+    }
+
+    for (; x > 0; x--)
+    {
+        *outp++ = (inp[0] + inp[1] + inp[span] + inp[span+1] + 2)>>2;
+        inp += 2;
+    }
+}
+
+/* Grey, factor 4: 16 output pixels at a time. */
+static void
+down_box8_4_sse2(byte *outp, const byte *inp, int span, int awidth)
+{
+    const __m128i even = _mm_set1_epi16(0xff);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i eight = _mm_set1_epi16(8);
+    int   x = awidth;
+
+    for (; x >= 16; x -= 16)
+    {
+        __m128i q[4];
+        int i, y;
+
+        for (i = 0; i < 4; i++)
+        {
+            /* Pairwise sums down the 4 rows, then add adjacent pairs */
+            __m128i sum = _mm_setzero_si128();
+
+            for (y = 0; y < 4; y++)
+            {
+                __m128i v = _mm_loadu_si128((const __m128i *)(inp + span*y + 16*i));
+                sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_and_si128(v, even), _mm_srli_epi16(v, 8)));
+            }
+            q[i] = _mm_madd_epi16(sum, ones);
+        }
+        q[0] = _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(q[0], q[1]), eight), 4);
+        q[2] = _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(q[2], q[3]), eight), 4);
+        _mm_storeu_si128((__m128i *)outp, _mm_packus_epi16(q[0], q[2]));
+        inp += 64;
+        outp += 16;
+    }
+
+    for (; x > 0; x--)
+    {
+        *outp++ = (inp[0     ] + inp[       1] + inp[       2] + inp[       3] +
+                   inp[span  ] + inp[span  +1] + inp[span  +2] + inp[span  +3] +
+                   inp[span*2] + inp[span*2+1] + inp[span*2+2] + inp[span*2+3] +
+                   inp[span*3] + inp[span*3+1] + inp[span*3+2] + inp[span*3+3] +
+                   8)>>4;
+        inp += 4;
+    }
+}
+
+/* We sum the rows first (vectorised), then the columns, which gives
+ * exactly the same results as summing each box in turn. */
+void
+gx_downscale_box8_sse2(byte *outp, byte *in_buffer, int span, int width,
+                       int awidth, int factor, int nc)
+{
+    uint16_t sums[DOWN_SUM_CHUNK];
+    int   x, xx, y, c, n, value;
+    const byte *inp = in_buffer;
+    int   div   = factor*factor;
+    int   step  = factor*nc;
+    int   chunk = DOWN_SUM_CHUNK / step;
+
+    /* Each chunk must hold a whole pixel, and the sums must fit. */
+    if (chunk < 1 || factor > DOWN_SUM_MAX_FACTOR)
+    {
+        gx_downscale_box8_c(outp, in_buffer, span, width, awidth, factor, nc);
+        return;
+    }
+
+    down_pad_white(in_buffer, span, width, awidth, factor, nc);
+
+    if (nc == 1 && factor == 2)
+    {
+        down_box8_2_sse2(outp, in_buffer, span, awidth);
+        return;
+    }
+    if (nc == 1 && factor == 4)
+    {
+        down_box8_4_sse2(outp, in_buffer, span, awidth);
+        return;
+    }
+
+    for (x = awidth; x > 0; x -= n)
+    {
+        const uint16_t *s = sums;
+
+        n = x < chunk ? x : chunk;
+        down_sum_rows(sums, inp, span, factor, n*step);
+        inp += n*step;
+        if (nc == 1 && factor == 3)
+        {
+            for (xx = n; xx > 0; xx--)
+            {
+                *outp++ = (s[0] + s[1] + s[2] + 4)/9;
+                s += 3;
+            }
+            continue;
+        }
+        for (xx = n; xx > 0; xx--)
+        {
+            for (c = 0; c < nc; c++)
+            {
+                value = 0;
+                for (y = c; y < step; y += nc)
+                    value += s[y];
+                *outp++ = (value+(div>>1))/div;
+            }
+            s += step;
+        }
+    }
+}
+
+void
+gx_downscale_box16_sse2(byte *outp, byte *in_buffer, int span, int width,
+                        int awidth, int factor)
+{
+    uint32_t sums[DOWN_SUM_CHUNK];
+    int   x, xx, y, n, value;
+    const byte *inp = in_buffer;
+    int   div   = factor*factor;
+    int   chunk = DOWN_SUM_CHUNK / factor;
+
+    /* Each chunk must hold a whole pixel. */
+    if (chunk < 1)
+    {
+        gx_downscale_box16_c(outp, in_buffer, span, width, awidth, factor);
+        return;
+    }
+
+    down_pad_white(in_buffer, span, width, awidth, factor, 2);
+
+    for (x = awidth; x > 0; x -= n)
+    {
+        const uint32_t *s = sums;
+
+        n = x < chunk ? x : chunk;
+        down_sum_rows16(sums, inp, span, factor, n*factor);
+        inp += n*factor*2;
+        for (xx = n; xx > 0; xx--)
+        {
+            value = 0;
+            for (y = 0; y < factor; y++)
+                value += s[y];
+            value = (value + (div>>1))/div;
+            outp[0] = value>>8;
+            outp[1] = value;
+            outp += 2;
+            s += factor;
+        }
+    }
+}
+
+#endif /* HAVE_SSE2 */
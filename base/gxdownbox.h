@@ -0,0 +1,59 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  39 Mesa Street, Suite 108A, San Francisco,
+   CA 94129, USA, for further information.
+*/
+
+
+/* Box filter cores for the contone downscaler */
+
+#ifndef gxdownbox_INCLUDED
+#  define gxdownbox_INCLUDED
+
+#include "stdpre.h"
+
+/*
+ * Each of these averages factor x factor boxes of a chunky line held in
+ * factor rows, span bytes apart, starting at in_buffer, and writes awidth
+ * output pixels of nc components to outp. Any input pixels from width to
+ * awidth are first set to white (0xFF). gxdownscale.c only uses them for
+ * factors 2 to 8 (the 3/2 and 3/4 scales have cores of their own) and for
+ * 1, 3 or 4 components, but any factor and nc work; the SIMD versions
+ * fall back to the _c ones where their column sums can't cope.
+ *
+ * The _c versions are the plain per box loops; the SIMD versions give
+ * exactly the same output and side effects, and are checked against them
+ * by base/downbench.c ("make downbench"), which links this file and
+ * nothing else. gx_downscale_box8 and gx_downscale_box16 are whichever is
+ * best for the build.
+ *
+ * The 16 bit version takes big endian samples, and only one component, as
+ * that is all that gxdownscale.c ever gives it.
+ */
+void gx_downscale_box8_c(byte *outp, byte *in_buffer, int span, int width,
+                         int awidth, int factor, int nc);
+void gx_downscale_box16_c(byte *outp, byte *in_buffer, int span, int width,
+                          int awidth, int factor);
+
+#ifdef HAVE_SSE2
+void gx_downscale_box8_sse2(byte *outp, byte *in_buffer, int span, int width,
+                            int awidth, int factor, int nc);
+void gx_downscale_box16_sse2(byte *outp, byte *in_buffer, int span, int width,
+                             int awidth, int factor);
+#  define gx_downscale_box8 gx_downscale_box8_sse2
+#  define gx_downscale_box16 gx_downscale_box16_sse2
+#else
+#  define gx_downscale_box8 gx_downscale_box8_c
+#  define gx_downscale_box16 gx_downscale_box16_c
+#endif
+
+#endif /* gxdownbox_INCLUDED */
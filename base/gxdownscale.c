@@ -20,6 +20,7 @@
 #include "gdevprn.h"
 #include "assert_.h"
 #include "gsicc_cache.h"
+#include "gxdownbox.h"
 
 #ifdef WITH_CAL
 #include "cal_ets.h"
@@ -1185,6 +1186,7 @@ static void down_core4_mfs(gx_downscaler_t *ds,
 }
 
 /* Grey (or planar) downscale code */
+
 static void down_core16(gx_downscaler_t *ds,
                         byte            *outp,
                         byte            *in_buffer,
@@ -1192,51 +1194,7 @@ static void down_core16(gx_downscaler_t *ds,
                         int              plane,
                         int              span)
 {
-    int   x, xx, y, value;
-    int   pad_white;
-    byte *inp;
-    int   width  = ds->width;
-    int   awidth = ds->awidth;
-    int   factor = ds->factor;
-    int   div    = factor*factor;
-
-    pad_white = (awidth - width) * factor;
-    if (pad_white < 0)
-        pad_white = 0;
-
-    if (pad_white)
-    {
-        inp = in_buffer + width*2*factor;
-        for (y = factor; y > 0; y--)
-        {
-            memset(inp, 0xFF, pad_white*2);
-            inp += span;
-        }
-    }
-
-    inp = in_buffer;
-    {
-        /* Left to Right pass (no min feature size) */
-        const int back = span * factor -2;
-        for (x = awidth; x > 0; x--)
-        {
-            value = 0;
-            for (xx = factor; xx > 0; xx--)
-            {
-                for (y = factor; y > 0; y--)
-                {
-                    value += inp[0]<<8;
-                    value += inp[1];
-                    inp += span;
-                }
-                inp -= back;
-            }
-            value = (value + (div>>1))/div;
-            outp[0] = value>>8;
-            outp[1] = value;
-            outp += 2;
-        }
-    }
+    gx_downscale_box16(outp, in_buffer, span, ds->width, ds->awidth, ds->factor);
 }
 
 static void down_core8(gx_downscaler_t *ds,
@@ -1246,164 +1204,7 @@ static void down_core8(gx_downscaler_t *ds,
                        int              plane,
                        int              span)
 {
-    int   x, xx, y, value;
-    int   pad_white;
-    byte *inp;
-    int   width  = ds->width;
-    int   awidth = ds->awidth;
-    int   factor = ds->factor;
-    int   div    = factor*factor;
-
-    pad_white = (awidth - width) * factor;
-    if (pad_white < 0)
-        pad_white = 0;
-
-    if (pad_white)
-    {
-        inp = in_buffer + width*factor;
-        for (y = factor; y > 0; y--)
-        {
-            memset(inp, 0xFF, pad_white);
-            inp += span;
-        }
-    }
-
-    inp = in_buffer;
-    {
-        /* Left to Right pass (no min feature size) */
-        const int back = span * factor -1;
-        for (x = awidth; x > 0; x--)
-        {
-            value = 0;
-            for (xx = factor; xx > 0; xx--)
-            {
-                for (y = factor; y > 0; y--)
-                {
-                    value += *inp;
-                    inp += span;
-                }
-                inp -= back;
-            }
-            *outp++ = (value+(div>>1))/div;
-        }
-    }
-}
-
-static void down_core8_2(gx_downscaler_t *ds,
-                         byte            *outp,
-                         byte            *in_buffer,
-                         int              row,
-                         int              plane,
-                         int              span)
-{
-    int   x;
-    int   pad_white;
-    byte *inp;
-    int   width  = ds->width;
-    int   awidth = ds->awidth;
-
-    pad_white = (awidth - width) * 2;
-    if (pad_white < 0)
-        pad_white = 0;
-
-    if (pad_white)
-    {
-        inp = in_buffer + width*2;
-        for (x = 2; x > 0; x--)
-        {
-            memset(inp, 0xFF, pad_white);
-            inp += span;
-        }
-    }
-
-    inp = in_buffer;
-
-    /* Left to Right pass (no min feature size) */
-    for (x = awidth; x > 0; x--)
-    {
-        *outp++ = (inp[0] + inp[1] + inp[span] + inp[span+1] + 2)>>2;
-        inp += 2;
-    }
-}
-
-static void down_core8_3(gx_downscaler_t *ds,
-                         byte            *outp,
-                         byte            *in_buffer,
-                         int              row,
-                         int              plane,
-                         int              span)
-{
-    int   x;
-    int   pad_white;
-    byte *inp;
-    int   width  = ds->width;
-    int   awidth = ds->awidth;
-
-    pad_white = (awidth - width) * 3;
-    if (pad_white < 0)
-        pad_white = 0;
-
-    if (pad_white)
-    {
-        inp = in_buffer + width*3;
-        for (x = 3; x > 0; x--)
-        {
-            memset(inp, 0xFF, pad_white);
-            inp += span;
-        }
-    }
-
-    inp = in_buffer;
-
-    /* Left to Right pass (no min feature size) */
-    for (x = awidth; x > 0; x--)
-    {
-        *outp++ = (inp[0     ] + inp[       1] + inp[       2] +
-                   inp[span  ] + inp[span  +1] + inp[span  +2] +
-                   inp[span*2] + inp[span*2+1] + inp[span*2+2] + 4)/9;
-        inp += 3;
-    }
-}
-
-static void down_core8_4(gx_downscaler_t *ds,
-                         byte            *outp,
-                         byte            *in_buffer,
-                         int              row,
-                         int              plane,
-                         int              span)
-{
-    int   x;
-    int   pad_white;
-    byte *inp;
-    int   width  = ds->width;
-    int   awidth = ds->awidth;
-
-    pad_white = (awidth - width) * 4;
-    if (pad_white < 0)
-        pad_white = 0;
-
-    if (pad_white)
-    {
-        inp = in_buffer + width*4;
-        for (x = 4; x > 0; x--)
-        {
-            memset(inp, 0xFF, pad_white);
-            inp += span;
-        }
-    }
-
-    inp = in_buffer;
-
-    /* Left to Right pass (no min feature size) */
-    for (x = awidth; x > 0; x--)
-    {
-        *outp++ = (inp[0     ] + inp[       1] + inp[       2] + inp[       3] +
-                   inp[span  ] + inp[span  +1] + inp[span  +2] + inp[span  +3] +
-                   inp[span*2] + inp[span*2+1] + inp[span*2+2] + inp[span*2+3] +
-                   inp[span*3] + inp[span*3+1] + inp[span*3+2] + inp[span*3+3] +
-                   8)>>4;
-        inp += 4;
-    }
+    gx_downscale_box8(outp, in_buffer, span, ds->width, ds->awidth, ds->factor, 1);
 }
 
 static void down_core8_3_2(gx_downscaler_t *ds,
@@ -1529,76 +1330,7 @@ static void down_core24(gx_downscaler_t *ds,
                         int              plane,
                         int              span)
 {
-    int   x, xx, y, value;
-    int   pad_white;
-    byte *inp;
-    int   width  = ds->width;
-    int   awidth = ds->awidth;
-    int   factor = ds->factor;
-    int   div    = factor*factor;
-
-    pad_white = (awidth - width) * factor * 3;
-    if (pad_white < 0)
-        pad_white = 0;
-
-    if (pad_white)
-    {
-        inp = in_buffer + width*factor*3;
-        for (y = factor; y > 0; y--)
-        {
-            memset(inp, 0xFF, pad_white);
-            inp += span;
-        }
-    }
-
-    inp = in_buffer;
-    {
-        /* Left to Right pass (no min feature size) */
-        const int back  = span * factor - 3;
-        const int back2 = factor * 3 - 1;
-        for (x = awidth; x > 0; x--)
-        {
-            /* R */
-            value = 0;
-            for (xx = factor; xx > 0; xx--)
-            {
-                for (y = factor; y > 0; y--)
-                {
-                    value += *inp;
-                    inp += span;
-                }
-                inp -= back;
-            }
-            inp -= back2;
-            *outp++ = (value+(div>>1))/div;
-            /* G */
-            value = 0;
-            for (xx = factor; xx > 0; xx--)
-            {
-                for (y = factor; y > 0; y--)
-                {
-                    value += *inp;
-                    inp += span;
-                }
-                inp -= back;
-            }
-            inp -= back2;
-            *outp++ = (value+(div>>1))/div;
-            /* B */
-            value = 0;
-            for (xx = factor; xx > 0; xx--)
-            {
-                for (y = factor; y > 0; y--)
-                {
-                    value += *inp;
-                    inp += span;
-                }
-                inp -= back;
-            }
-            inp -= 2;
-            *outp++ = (value+(div>>1))/div;
-        }
-    }
+    gx_downscale_box8(outp, in_buffer, span, ds->width, ds->awidth, ds->factor, 3);
 }
 
 /* CMYK downscale (no error diffusion) code */
@@ -1610,89 +1342,7 @@ static void down_core32(gx_downscaler_t *ds,
                         int              plane,
                         int              span)
 {
-    int   x, xx, y, value;
-    int   pad_white;
-    byte *inp;
-    int   width  = ds->width;
-    int   awidth = ds->awidth;
-    int   factor = ds->factor;
-    int   div    = factor*factor;
-
-    pad_white = (awidth - width) * factor * 4;
-    if (pad_white < 0)
-        pad_white = 0;
-
-    if (pad_white)
-    {
-        inp = in_buffer + width*factor*4;
-        for (y = factor; y > 0; y--)
-        {
-            memset(inp, 0xFF, pad_white);
-            inp += span;
-        }
-    }
-
-    inp = in_buffer;
-    {
-        /* Left to Right pass (no min feature size) */
-        const int back  = span * factor - 4;
-        const int back2 = factor * 4 - 1;
-        for (x = awidth; x > 0; x--)
-        {
-            /* C */
-            value = 0;
-            for (xx = factor; xx > 0; xx--)
-            {
-                for (y = factor; y > 0; y--)
-                {
-                    value += *inp;
-                    inp += span;
-                }
-                inp -= back;
-            }
-            inp -= back2;
-            *outp++ = (value+(div>>1))/div;
-            /* M */
-            value = 0;
-            for (xx = factor; xx > 0; xx--)
-            {
-                for (y = factor; y > 0; y--)
-                {
-                    value += *inp;
-                    inp += span;
-                }
-                inp -= back;
-            }
-            inp -= back2;
-            *outp++ = (value+(div>>1))/div;
-            /* Y */
-            value = 0;
-            for (xx = factor; xx > 0; xx--)
-            {
-                for (y = factor; y > 0; y--)
-                {
-                    value += *inp;
-                    inp += span;
-                }
-                inp -= back;
-            }
-            inp -= back2;
-            *outp++ = (value+(div>>1))/div;
-            /* K */
-            value = 0;
-            for (xx = factor; xx > 0; xx--)
-            {
-                for (y = factor; y > 0; y--)
-                {
-                    value += *inp;
-                    inp += span;
-                }
-                inp -= back;
-            }
-            inp -= 3;
-            *outp++ = (value+(div>>1))/div;
-        }
-    }
+    gx_downscale_box8(outp, in_buffer, span, ds->width, ds->awidth, ds->factor, 4);
 }
 
 void gx_downscaler_decode_factor(int factor, int *up, int *down)
@@ -2486,12 +2136,6 @@ int gx_downscaler_init_planar_cm(gx_downscaler_t      *ds,
         core = NULL;
     else if (src_bpc == 16)
         core = &down_core16;
-    else if (factor == 4)
-        core = &down_core8_4;
-    else if (factor == 3)
-        core = &down_core8_3;
-    else if (factor == 2)
-        core = &down_core8_2;
     else
         core = &down_core8;
     ds->down_core = core;
@@ -2579,16 +2223,7 @@ select_8_to_8_core(int nc, int factor)
     if (factor == 1)
         return NULL; /* No sense doing anything */
     if (nc == 1)
-    {
-        if (factor == 4)
-            return &down_core8_4;
-        else if (factor == 3)
-            return &down_core8_3;
-        else if (factor == 2)
-            return &down_core8_2;
-        else
-            return &down_core8;
-    }
+        return &down_core8;
     else if (nc == 3)
         return &down_core24;
     else if (nc == 4)
@@ -3336,16 +2971,7 @@ int gx_downscaler_process_page(gx_device                 *dev,
     else if (factor == 1)
         core = NULL;
     else if ((src_bpc == 8) && (num_comps == 1))
-    {
-        if (factor == 4)
-            core = &down_core8_4;
-        else if (factor == 3)
-            core = &down_core8_3;
-        else if (factor == 2)
-            core = &down_core8_2;
-        else
-            core = &down_core8;
-    }
+        core = &down_core8;
     else if ((src_bpc == 8) && (num_comps == 3))
         core = &down_core24;
     else if ((src_bpc == 8) && (num_comps == 4))
@@ -38,6 +38,7 @@
 #include "gxdevsop.h"
 
 #include "gxfapi.h"
+#include "gxstats.h"
 
 #define FAPI_ROUND(v) (v >= 0 ? v + 0.5 : v - 0.5)
 #define FAPI_ROUND_TO_FRACINT(v) ((fracint)FAPI_ROUND(v))
@@ -1210,10 +1211,10 @@ gs_fapi_finish_render(gs_font *pfont, gs_gstate *pgs, gs_text_enum_t *penum, gs_
 #define MTX_EQ(mtx1,mtx2) (mtx1->xx == mtx2->xx && mtx1->xy == mtx2->xy && \
                            mtx1->yx == mtx2->yx && mtx1->yy == mtx2->yy)
 
-int
-gs_fapi_do_char(gs_font *pfont, gs_gstate *pgs, gs_text_enum_t *penum, char *font_file_path,
-                bool bBuildGlyph, gs_string *charstring, gs_string *glyphname,
-                gs_char chr, gs_glyph index, int subfont)
+static int
+fapi_do_char(gs_font *pfont, gs_gstate *pgs, gs_text_enum_t *penum, char *font_file_path,
+             bool bBuildGlyph, gs_string *charstring, gs_string *glyphname,
+             gs_char chr, gs_glyph index, int subfont)
 {                               /* Stack : <font> <code|name> --> - */
     gs_show_enum *penum_s = (gs_show_enum *) penum;
     gx_device *dev = gs_currentdevice_inline(pgs);
@@ -1771,6 +1772,22 @@ retry_scaling:
     return code;
 }
 
+/* Rendering a glyph, timed for EmitStats. */
+int
+gs_fapi_do_char(gs_font *pfont, gs_gstate *pgs, gs_text_enum_t *penum, char *font_file_path,
+                bool bBuildGlyph, gs_string *charstring, gs_string *glyphname,
+                gs_char chr, gs_glyph index, int subfont)
+{
+    gx_stats_clock t;
+    int code;
+
+    gx_stats_begin(pgs->memory, t);
+    code = fapi_do_char(pfont, pgs, penum, font_file_path, bBuildGlyph,
+                        charstring, glyphname, chr, index, subfont);
+    gx_stats_end(pgs->memory, gx_stats_glyph, t);
+    return code;
+}
+
 int
 gs_fapi_get_font_info(gs_font *pfont, gs_fapi_font_info item, int index,
                       void *data, int *data_len)
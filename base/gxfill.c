@@ -673,6 +673,69 @@ gx_default_fill_path(gx_device * pdev, const gs_gstate * pgs,
         return gx_general_fill_path(pdev, pgs, ppath, params, pdevc, pcpath);
 }
 
+/*
+ * Fill a path with antialiasing, using the analytic coverage scan
+ * converter to draw straight onto the device (with copy_alpha for the
+ * edges) rather than oversampling into an alpha buffer. This bypasses
+ * the device's fill_path, just as the alpha buffer does. The colour
+ * must be pure or devn.
+ */
+int
+gx_coverage_fill_path(gx_device * pdev, const gs_gstate * pgs,
+                      gx_path * ppath, const gx_fill_params * params,
+                const gx_device_color * pdevc, const gx_clip_path * pcpath)
+{
+    gs_logical_operation_t lop = pgs->log_op;
+    gs_fixed_rect ibox, bbox;
+    gx_device_clip cdev;
+    gx_device *dev = pdev;
+    gx_path ffpath;
+    int clipping = 0;
+    int code;
+
+    gx_path_bbox(ppath, &ibox);
+    if (pcpath)
+        gx_cpath_inner_box(pcpath, &bbox);
+    else
+        (*dev_proc(dev, get_clipping_box)) (dev, &bbox);
+    if (!rect_within(ibox, bbox)) {
+        if (pcpath)
+            gx_cpath_outer_box(pcpath, &bbox);
+        rect_intersect(ibox, bbox);
+        if (ibox.p.x >= ibox.q.x || ibox.p.y >= ibox.q.y)
+            return 0;
+        if (pcpath) {
+            dev = (gx_device *) & cdev;
+            gx_make_clip_device_on_stack(&cdev, pcpath, pdev);
+            cdev.max_fill_band = pdev->max_fill_band;
+            clipping = 1;
+        }
+    }
+    if (pgs->accurate_curves && gx_path_has_curves(ppath)) {
+        gx_path_init_local(&ffpath, ppath->memory);
+        code = gx_path_copy_reducing(ppath, &ffpath,
+                                     float2fixed(params->flatness), NULL,
+                                     pco_small_curves | pco_accurate);
+        if (code < 0)
+            goto out;
+        ppath = &ffpath;
+    }
+    code = gx_scan_convert_and_fill(&gx_scan_converter_aa,
+                                    dev,
+                                    ppath,
+                                    &ibox,
+                                    float2fixed(params->flatness),
+                                    params->rule,
+                                    pdevc,
+                                    color_writes_pure(pdevc, lop) ? -1 : (int)lop);
+    if (ppath == &ffpath)
+        gx_path_free(ppath, "gx_coverage_fill_path");
+out:
+    if (clipping)
+        gx_destroy_clip_device_on_stack(&cdev);
+    return code;
+}
+
 int
 gx_default_lock_pattern(gx_device *pdev,
                         gs_gstate *pgs,
@@ -440,6 +440,223 @@ decode_row(const gx_image_enum *penum, const byte *psrc, int spp, byte *pdes,
     }
 }
 
+/*
+ * The Decode mapping of a sample only depends on its value, so rather
+ * than doing the arithmetic for every sample of every row, we build a
+ * table of 256 entries per component once per image, by running the
+ * decode procedures above over all the possible values.
+ *
+ * Converting through the ICC link is done a row at a time, but images
+ * with few distinct colours (charts, screen shots, logos) send the same
+ * handful of colours to the CMM over and over again.  For those we keep
+ * a memo of converted pixels, direct mapped on a hash of the source
+ * pixel.  A row is first looked up in the memo, collecting the colours
+ * that are missing; only those go through the link, and the row is then
+ * filled in from the memo.  If a row turns out to have too many new
+ * colours we give up on it and convert the whole row as usual, and after
+ * a few such rows we stop using the memo for the rest of the image, so
+ * that photographic images pay very little for it.
+ */
+#define ICC_MEMO_LOG2_SIZE 10
+#define ICC_MEMO_SIZE (1 << ICC_MEMO_LOG2_SIZE)
+#define ICC_MEMO_HASH(key)\
+  ((uint)((bits32)((key) * 0x9e3779b1) >> (32 - ICC_MEMO_LOG2_SIZE)))
+#define ICC_MEMO_MAX_MISSES 256         /* new colours per row */
+#define ICC_MEMO_MAX_FAILURES 4         /* rows before giving up */
+#define ICC_MEMO_MAX_IN 4               /* source components, packed in a key */
+#define ICC_MEMO_MAX_OUT 8              /* device components */
+#define ICC_MEMO_MIN_WIDTH 16           /* don't bother with narrower images */
+
+struct gx_image_icc_work_s {
+    bool use_memo;
+    int failures;
+    bits32 row;                         /* stamp of the current row */
+    bits32 keys[ICC_MEMO_SIZE];
+    bits32 stamps[ICC_MEMO_SIZE];       /* last row to use each entry */
+    byte valid[ICC_MEMO_SIZE];
+    byte values[ICC_MEMO_SIZE * ICC_MEMO_MAX_OUT];
+    ushort miss_slots[ICC_MEMO_MAX_MISSES];
+    byte miss_in[ICC_MEMO_MAX_MISSES * ICC_MEMO_MAX_IN];
+    byte miss_out[ICC_MEMO_MAX_MISSES * ICC_MEMO_MAX_OUT];
+    /* The decode table, 256 entries per component, follows. */
+};
+#define icc_work_decode_table(work) ((byte *)((work) + 1))
+
+/* Allocate the working storage for image_color_icc_prep. */
+static int
+image_init_icc_work(gx_image_enum *penum, int width, int spp_cm)
+{
+    int spp = penum->spp;
+    bool need_decode = penum->icc_setup.need_decode;
+    gx_image_icc_work_t *work;
+    byte *src, *des;
+    int v, k;
+
+    work = (gx_image_icc_work_t *)
+        gs_alloc_bytes(penum->memory,
+                       sizeof(gx_image_icc_work_t) + (need_decode ? 256 * spp : 0),
+                       "image_init_icc_work");
+    if (work == NULL)
+        return_error(gs_error_VMerror);
+    work->use_memo = !penum->icc_link->is_identity && spp <= ICC_MEMO_MAX_IN &&
+        spp_cm <= ICC_MEMO_MAX_OUT && width >= ICC_MEMO_MIN_WIDTH;
+    work->failures = 0;
+    work->row = 0;
+    memset(work->keys, 0, sizeof(work->keys));
+    memset(work->stamps, 0, sizeof(work->stamps));
+    memset(work->valid, 0, sizeof(work->valid));
+    if (need_decode) {
+        byte *table = icc_work_decode_table(work);
+
+        src = gs_alloc_bytes(penum->memory, 2 * 256 * spp, "image_init_icc_work");
+        if (src == NULL) {
+            gs_free_object(penum->memory, work, "image_init_icc_work");
+            return_error(gs_error_VMerror);
+        }
+        des = src + 256 * spp;
+        for (v = 0; v < 256; v++)
+            memset(src + v * spp, v, spp);
+        if (!penum->use_cie_range)
+            decode_row(penum, src, spp, des, des + 256 * spp);
+        else
+            decode_row_cie(penum, src, spp, des, des + 256 * spp,
+                           get_cie_range(penum->pcs));
+        for (k = 0; k < spp; k++)
+            for (v = 0; v < 256; v++)
+                table[(k << 8) + v] = des[v * spp + k];
+        gs_free_object(penum->memory, src, "image_init_icc_work");
+    }
+    penum->icc_work = work;
+    return 0;
+}
+
+/* Apply the Decode mapping to a row of w samples. */
+static void
+decode_row_table(const byte *table, const byte *psrc, int spp, byte *pdes,
+                 uint w)
+{
+    const byte *end = psrc + w;
+    int k;
+
+    switch (spp) {
+        case 3:
+            for (; psrc < end; psrc += 3, pdes += 3) {
+                pdes[0] = table[psrc[0]];
+                pdes[1] = table[256 + psrc[1]];
+                pdes[2] = table[512 + psrc[2]];
+            }
+            break;
+        case 4:
+            for (; psrc < end; psrc += 4, pdes += 4) {
+                pdes[0] = table[psrc[0]];
+                pdes[1] = table[256 + psrc[1]];
+                pdes[2] = table[512 + psrc[2]];
+                pdes[3] = table[768 + psrc[3]];
+            }
+            break;
+        default:
+            while (psrc < end)
+                for (k = 0; k < spp; k++)
+                    *pdes++ = table[(k << 8) + *psrc++];
+    }
+}
+
+static inline bits32
+icc_memo_key(const byte *p, int spp)
+{
+    bits32 key = p[0];
+    int k;
+
+    for (k = 1; k < spp; k++)
+        key = (key << 8) | p[k];
+    return key;
+}
+
+/*
+ * Convert a row of width pixels through the link with the help of the
+ * memo, writing chunky output or, if planestride is not 0, planar output.
+ * Return 1 if the memo couldn't be used for this row.
+ */
+static int
+image_color_icc_memo_row(gx_device *dev, gsicc_link_t *link,
+                         gx_image_icc_work_t *work, const byte *psrc,
+                         int spp, int width, byte *pdes, int spp_cm,
+                         int planestride)
+{
+    int limit = min(width / 4, ICC_MEMO_MAX_MISSES);
+    int num_misses = 0;
+    bits32 row = ++(work->row);
+    bits32 key, prev_key = 0;
+    const byte *p;
+    const byte *value = NULL;
+    uint slot;
+    int i, k, code;
+
+    /* Look up each pixel, entering the missing colours as we go. */
+    for (i = 0, p = psrc; i < width; i++, p += spp) {
+        key = icc_memo_key(p, spp);
+        if (i > 0 && key == prev_key)
+            continue;
+        prev_key = key;
+        slot = ICC_MEMO_HASH(key);
+        if (work->keys[slot] == key &&
+            (work->valid[slot] || work->stamps[slot] == row)) {
+            /* Either converted already, or about to be. */
+            work->stamps[slot] = row;
+            continue;
+        }
+        /* We can't replace an entry that this row needs. */
+        if (work->stamps[slot] == row || num_misses == limit)
+            goto fail;
+        work->valid[slot] = false;
+        work->keys[slot] = key;
+        work->stamps[slot] = row;
+        work->miss_slots[num_misses] = slot;
+        memcpy(work->miss_in + num_misses * spp, p, spp);
+        num_misses++;
+    }
+    if (num_misses > 0) {
+        gsicc_bufferdesc_t input_buff_desc;
+        gsicc_bufferdesc_t output_buff_desc;
+
+        gsicc_init_buffer(&input_buff_desc, spp, 1, false, false, false, 0,
+                          num_misses * spp, 1, num_misses);
+        gsicc_init_buffer(&output_buff_desc, spp_cm, 1, false, false, false, 0,
+                          num_misses * spp_cm, 1, num_misses);
+        code = (link->procs.map_buffer)(dev, link, &input_buff_desc,
+                                        &output_buff_desc, work->miss_in,
+                                        work->miss_out);
+        if (code < 0)
+            return code;
+        for (i = 0; i < num_misses; i++) {
+            slot = work->miss_slots[i];
+            memcpy(work->values + slot * ICC_MEMO_MAX_OUT,
+                   work->miss_out + i * spp_cm, spp_cm);
+            work->valid[slot] = true;
+        }
+    }
+    /* Now fill in the row. */
+    for (i = 0, p = psrc; i < width; i++, p += spp) {
+        key = icc_memo_key(p, spp);
+        if (i == 0 || key != prev_key) {
+            prev_key = key;
+            value = work->values + ICC_MEMO_HASH(key) * ICC_MEMO_MAX_OUT;
+        }
+        if (planestride == 0) {
+            for (k = 0; k < spp_cm; k++)
+                *pdes++ = value[k];
+        } else {
+            for (k = 0; k < spp_cm; k++)
+                pdes[k * planestride + i] = value[k];
+        }
+    }
+    return 0;
+ fail:
+    if (++(work->failures) >= ICC_MEMO_MAX_FAILURES)
+        work->use_memo = false;
+    return 1;
+}
+
 /* Common code shared amongst the thresholding and non thresholding color image
    renderers */
 static int
@@ -492,36 +709,42 @@ image_color_icc_prep(gx_image_enum *penum_orig, const byte *psrc, uint w,
 
         if (pspan)
             *pspan = span;
+        if (penum->icc_work == NULL) {
+            code = image_init_icc_work(penum_orig, width, spp_cm);
+            if (code < 0)
+                return code;
+        }
         /* Put the buffer on a 32 byte memory alignment for SSE/AVX for every
          * line. Also extra space for 32 byte overrun. */
         *psrc_cm_start = gs_alloc_bytes(pgs->memory,  span * spp_cm + 64,
                                         "image_color_icc_prep");
+        if (*psrc_cm_start == NULL)
+            return_error(gs_error_VMerror);
         *psrc_cm = *psrc_cm_start + ((32 - (intptr_t)(*psrc_cm_start)) & 31);
         *bufend = *psrc_cm +  span * spp_cm;
+        if (need_decode && (!penum->icc_link->is_identity || force_planar)) {
+            psrc_decode = gs_alloc_bytes(pgs->memory, w,
+                                         "image_color_icc_prep");
+            if (psrc_decode == NULL) {
+                gs_free_object(pgs->memory, *psrc_cm_start, "image_color_icc_prep");
+                *psrc_cm_start = NULL;
+                return_error(gs_error_VMerror);
+            }
+            decode_row_table(icc_work_decode_table(penum->icc_work), psrc,
+                             spp, psrc_decode, w);
+        } else {
+            psrc_decode = NULL;
+        }
         if (penum->icc_link->is_identity) {
             if (!force_planar) {
-                /* decode only. no CM.  This is slow but does not happen that often */
-                decode_row(penum, psrc, spp, *psrc_cm, *bufend);
+                /* decode only. no CM. */
+                decode_row_table(icc_work_decode_table(penum->icc_work), psrc,
+                                 spp, *psrc_cm, w);
             } else {
                 /* CM is identity but we may need to do decode and then off
                    to planar. The planar out case is only used when coming from
                    imager_render_color_thresh, which is limited to 8 bit case */
-                if (need_decode) {
-                    /* Need decode and then to planar */
-                    psrc_decode = gs_alloc_bytes(pgs->memory,  w,
-                                                  "image_color_icc_prep");
-                    if (!penum->use_cie_range) {
-                        decode_row(penum, psrc, spp, psrc_decode, psrc_decode+w);
-                    } else {
-                        /* Decode needs to include adjustment for CIE range */
-                        decode_row_cie(penum, psrc, spp, psrc_decode,
-                                        psrc_decode + w, get_cie_range(penum->pcs));
-                    }
-                    planar_src = psrc_decode;
-                } else {
-                    psrc_decode = NULL;
-                    planar_src = psrc;
-                }
+                planar_src = (psrc_decode != NULL ? psrc_decode : psrc);
                 /* Now to planar */
                 planar_des = *psrc_cm;
                 for (k = 0; k < width; k++) {
@@ -530,61 +753,42 @@ image_color_icc_prep(gx_image_enum *penum_orig, const byte *psrc, uint w,
                     }
                     planar_des++;
                 }
-                /* Free up decode if we used it */
-                if (psrc_decode != NULL) {
-                    gs_free_object(pgs->memory, (byte *) psrc_decode,
-                                   "image_render_color_icc");
-                }
             }
         } else {
-            /* Set up the buffer descriptors. planar out always ends up here */
-            gsicc_init_buffer(&input_buff_desc, spp, 1,
-                          false, false, false, 0, w,
-                          1, width);
-            if (!force_planar) {
-                gsicc_init_buffer(&output_buff_desc, spp_cm, 1,
-                              false, false, false, 0, width * spp_cm,
-                              1, width);
-            } else {
-                gsicc_init_buffer(&output_buff_desc, spp_cm, 1,
-                              false, false, true, span, span,
+            const byte *cm_src = (psrc_decode != NULL ? psrc_decode : psrc);
+
+            code = 1;
+            if (penum->icc_work->use_memo)
+                code = image_color_icc_memo_row(dev, penum->icc_link,
+                                                penum->icc_work, cm_src, spp,
+                                                width, *psrc_cm, spp_cm,
+                                                force_planar ? span : 0);
+            if (code == 1) {
+                /* Set up the buffer descriptors. planar out always ends up here */
+                gsicc_init_buffer(&input_buff_desc, spp, 1,
+                              false, false, false, 0, w,
                               1, width);
-            }
-            /* For now, just blast it all through the link. If we had a significant reduction
-               we will want to repack the data first and then do this.  That will be
-               an optimization shortly.  For now just allocate a new output
-               buffer.  We can reuse the old one if the number of channels in the output is
-               less than or equal to the new one.  */
-            if (need_decode) {
-                /* Need decode and CM.  This is slow but does not happen that often */
-                psrc_decode = gs_alloc_bytes(pgs->memory, w,
-                                              "image_color_icc_prep");
-                if (!penum->use_cie_range) {
-                    decode_row(penum, psrc, spp, psrc_decode, psrc_decode+w);
+                if (!force_planar) {
+                    gsicc_init_buffer(&output_buff_desc, spp_cm, 1,
+                                  false, false, false, 0, width * spp_cm,
+                                  1, width);
                 } else {
-                    /* Decode needs to include adjustment for CIE range */
-                    decode_row_cie(penum, psrc, spp, psrc_decode,
-                                    psrc_decode+w, get_cie_range(penum->pcs));
+                    gsicc_init_buffer(&output_buff_desc, spp_cm, 1,
+                                  false, false, true, span, span,
+                                  1, width);
                 }
                 code = (penum->icc_link->procs.map_buffer)(dev, penum->icc_link,
                                                     &input_buff_desc,
                                                     &output_buff_desc,
-                                                    (void*) psrc_decode,
-                                                    (void*) *psrc_cm);
-                gs_free_object(pgs->memory, psrc_decode, "image_color_icc_prep");
-                if (code < 0)
-                    return code;
-            } else {
-                /* CM only. No decode */
-                code = (penum->icc_link->procs.map_buffer)(dev, penum->icc_link,
-                                                    &input_buff_desc,
-                                                    &output_buff_desc,
-                                                    (void*) psrc,
+                                                    (void*) cm_src,
                                                     (void*) *psrc_cm);
-                if (code < 0)
-                    return code;
             }
         }
+        /* Free up decode if we used it */
+        if (psrc_decode != NULL)
+            gs_free_object(pgs->memory, psrc_decode, "image_color_icc_prep");
+        if (code < 0)
+            return code;
     }
     *spp_cm_out = spp_cm;
     return 0;
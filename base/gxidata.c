@@ -529,6 +529,9 @@ gx_image1_end_image(gx_image_enum_common_t * info, bool draw_last)
                        "image is_transparent");
         gs_free_object(mem, penum->color_cache, "image color cache");
     }
+    if (penum->icc_work != NULL) {
+        gs_free_object(mem, penum->icc_work, "image icc_work");
+    }
     if (penum->thresh_buffer != NULL) {
         gs_free_object(mem, penum->thresh_buffer, "image thresh_buffer");
     }
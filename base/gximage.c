@@ -24,6 +24,7 @@
 #include "gxcolor2.h"		/* for lookup map */
 #include "gxiparam.h"
 #include "stream.h"
+#include "gxstats.h"
 
 /* ---------------- Generic image support ---------------- */
 
@@ -172,7 +173,13 @@ gx_image_plane_data_rows(gx_image_enum_common_t * info,
                          const gx_image_plane_t * planes, int height,
                          int *rows_used)
 {
-    return info->procs->plane_data(info, planes, height, rows_used);
+    gx_stats_clock t;
+    int code;
+
+    gx_stats_begin(info->memory, t);
+    code = info->procs->plane_data(info, planes, height, rows_used);
+    gx_stats_end(info->memory, gx_stats_image, t);
+    return code;
 }
 
 int
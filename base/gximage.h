@@ -151,6 +151,13 @@ typedef struct gx_image_color_cache_s {
     byte *device_contone;
 } gx_image_color_cache_t;
 
+/*
+ * Working storage for the ICC colour image renderers (see gxicolor.c):
+ * a table for the Decode mapping of the samples and a memo of colours
+ * already converted through the link.  It is a single block of bytes.
+ */
+typedef struct gx_image_icc_work_s gx_image_icc_work_t;
+
 /* Main state structure */
 
 typedef struct gx_device_rop_texture_s gx_device_rop_texture;
@@ -282,6 +289,7 @@ struct gx_image_enum_s {
     gx_device_color *icolor1;
     gsicc_link_t *icc_link; /* ICC link to avoid recreation with every line */
     gx_image_color_cache_t *color_cache;  /* A cache that is con-tone values */
+    gx_image_icc_work_t *icc_work; /* Decode table and colour memo, lazily allocated */
     byte *ht_buffer;            /* A buffer to contain halftoned data */
     int ht_stride;
     int ht_offset_bits;     /* An offset adjustement to allow aligned copies */
@@ -304,8 +312,8 @@ struct gx_image_enum_s {
   m(0,pcs) m(1,dev) m(2,buffer) m(3,line)\
   m(4,clip_dev) m(5,rop_dev) m(6,scaler) m(7,icc_link)\
   m(8,color_cache) m(9,ht_buffer) m(10,thresh_buffer) \
-  m(11,clues)
-#define gx_image_enum_num_ptrs 12
+  m(11,clues) m(12,icc_work)
+#define gx_image_enum_num_ptrs 13
 #define private_st_gx_image_enum() /* in gsimage.c */\
   gs_private_st_composite(st_gx_image_enum, gx_image_enum, "gx_image_enum",\
     image_enum_enum_ptrs, image_enum_reloc_ptrs)
@@ -22,6 +22,7 @@
 #include "gxpaint.h"
 #include "gxpath.h"
 #include "gxfont.h"
+#include "gxstats.h"
 
 static bool caching_an_outline_font(const gs_gstate * pgs)
 {
@@ -43,6 +44,7 @@ gx_fill_path(gx_path * ppath, gx_device_color * pdevc, gs_gstate * pgs,
     gx_clip_path *pcpath;
     int code = gx_effective_clip_path(pgs, &pcpath);
     gx_fill_params params;
+    gx_stats_clock t;
 
     if (code < 0)
         return code;
@@ -50,8 +52,34 @@ gx_fill_path(gx_path * ppath, gx_device_color * pdevc, gs_gstate * pgs,
     params.adjust.x = adjust_x;
     params.adjust.y = adjust_y;
     params.flatness = (caching_an_outline_font(pgs) ? 0.0 : pgs->flatness);
-    return (*dev_proc(dev, fill_path))
+    gx_stats_begin(pgs->memory, t);
+    code = (*dev_proc(dev, fill_path))
         (dev, (const gs_gstate *)pgs, ppath, &params, pdevc, pcpath);
+    gx_stats_end(pgs->memory, gx_stats_fill_path, t);
+    return code;
+}
+
+/* Fill a path with antialiasing, computing the coverage analytically. */
+int
+gx_fill_path_coverage(gx_path * ppath, gx_device_color * pdevc,
+                      gs_gstate * pgs, int rule)
+{
+    gx_device *dev = gs_currentdevice_inline(pgs);
+    gx_clip_path *pcpath;
+    int code = gx_effective_clip_path(pgs, &pcpath);
+    gx_fill_params params;
+    gx_stats_clock t;
+
+    if (code < 0)
+        return code;
+    params.rule = rule;
+    params.adjust.x = params.adjust.y = 0;
+    params.flatness = (caching_an_outline_font(pgs) ? 0.0 : pgs->flatness);
+    gx_stats_begin(pgs->memory, t);
+    code = gx_coverage_fill_path(dev, (const gs_gstate *)pgs, ppath, &params,
+                                 pdevc, pcpath);
+    gx_stats_end(pgs->memory, gx_stats_fill_path, t);
+    return code;
 }
 
 /* Stroke a path for drawing or saving. */
@@ -62,15 +90,18 @@ gx_stroke_fill(gx_path * ppath, gs_gstate * pgs)
     gx_clip_path *pcpath;
     int code = gx_effective_clip_path(pgs, &pcpath);
     gx_stroke_params params;
+    gx_stats_clock t;
 
     if (code < 0)
         return code;
     params.flatness = (caching_an_outline_font(pgs) ? 0.0 : pgs->flatness);
     params.traditional = false;
 
+    gx_stats_begin(pgs->memory, t);
     code = (*dev_proc(dev, stroke_path))
         (dev, (const gs_gstate *)pgs, ppath, &params,
          gs_currentdevicecolor_inline(pgs), pcpath);
+    gx_stats_end(pgs->memory, gx_stats_stroke_path, t);
 
     if (pgs->black_textvec_state) {
         gsicc_restore_blacktextvec(pgs, true);
@@ -87,6 +118,7 @@ gx_fill_stroke_path(gs_gstate * pgs, int rule)
     int code = gx_effective_clip_path(pgs, &pcpath);
     gx_stroke_params stroke_params;
     gx_fill_params fill_params;
+    gx_stats_clock t;
 
     if (code < 0)
         return code;
@@ -97,11 +129,13 @@ gx_fill_stroke_path(gs_gstate * pgs, int rule)
     stroke_params.flatness = (caching_an_outline_font(pgs) ? 0.0 : pgs->flatness);
     stroke_params.traditional = false;
 
+    gx_stats_begin(pgs->memory, t);
     code = (*dev_proc(dev, fill_stroke_path))
         (dev, (const gs_gstate *)pgs, pgs->path,
          &fill_params, gs_currentdevicecolor_inline(pgs),
          &stroke_params, gs_swappeddevicecolor_inline(pgs),
          pcpath);
+    gx_stats_end(pgs->memory, gx_stats_fill_stroke_path, t);
 
     if (pgs->black_textvec_state) {
         gsicc_restore_blacktextvec(pgs, true);
@@ -34,6 +34,8 @@
 
 int gx_fill_path(gx_path * ppath, gx_device_color * pdevc, gs_gstate * pgs,
                  int rule, fixed adjust_x, fixed adjust_y);
+int gx_fill_path_coverage(gx_path * ppath, gx_device_color * pdevc,
+                          gs_gstate * pgs, int rule);
 int gx_stroke_fill(gx_path * ppath, gs_gstate * pgs);
 int gx_stroke_add(gx_path *ppath, gx_path *to_path, const gs_gstate * pgs, bool traditional);
 int gx_fill_stroke_path(gs_gstate *pgs, int rule);
@@ -85,6 +87,17 @@ struct gx_fill_params_s {
 #define gx_fill_path_only(ppath, dev, pgs, params, pdevc, pcpath)\
   (*dev_proc(dev, fill_path))(dev, pgs, ppath, params, pdevc, pcpath)
 
+/*
+ * Fill with antialiasing by computing the exact coverage of each pixel,
+ * rather than through an alpha buffer. This draws directly on dev with
+ * fill_rectangle and copy_alpha (or their hl_color equivalents), so the
+ * colour must be pure or devn.
+ */
+int gx_coverage_fill_path(gx_device * dev, const gs_gstate * pgs,
+                          gx_path * ppath, const gx_fill_params * params,
+                          const gx_device_color * pdevc,
+                          const gx_clip_path * pcpath);
+
 /* Define the parameters passed to the imager's stroke routine. */
 struct gx_stroke_params_s {
     float flatness;
@@ -26,6 +26,13 @@
  * Define a cache for rendered Patterns.  This is currently an open
  * hash table with single probing (no reprobing) and round-robin
  * replacement.  Obviously, we can do better in both areas.
+ *
+ * The tiles are keyed on the instance id, so a Pattern that is made
+ * again (on each page, say) is rendered again.  If -dPatternTileCache
+ * gives a budget, tiles whose content can be identified (see
+ * gx_pattern_load) are moved to the kept table rather than freed, where
+ * a later instance with the same content can find them.  The kept table
+ * is keyed on the content, with the same replacement scheme.
  */
 typedef struct gx_pattern_cache_s gx_pattern_cache;
 
@@ -38,10 +45,16 @@ struct gx_pattern_cache_s {
     size_t bits_used;
     size_t max_bits;
     void (*free_all) (gx_pattern_cache *);
+    gx_color_tile *kept;	/* 0 until first needed */
+    uint num_kept;
+    uint kept_next;		/* round-robin index */
+    size_t kept_bits;
+    gx_bitmap_id pending_id;	/* the instance being loaded, whose */
+    byte pending_key[16];	/* tile is to get this content key */
 };
 
 #define private_st_pattern_cache() /* in gxpcmap.c */\
-  gs_private_st_ptrs1(st_pattern_cache, gx_pattern_cache,\
-    "gx_pattern_cache", pattern_cache_enum, pattern_cache_reloc, tiles)
+  gs_private_st_ptrs2(st_pattern_cache, gx_pattern_cache,\
+    "gx_pattern_cache", pattern_cache_enum, pattern_cache_reloc, tiles, kept)
 
 #endif /* gxpcache_INCLUDED */
@@ -42,6 +42,13 @@
 #include "gscoord.h"
 #include "gsicc_blacktext.h"
 #include "gscspace.h"
+#include "gsmd5.h"
+#include "gsicc_cache.h"
+#include "gxfont.h"
+#include "gxdht.h"
+#include "gxfmap.h"
+#include "gscie.h"
+#include "gxstats.h"
 
 #if RAW_PATTERN_DUMP
 unsigned int global_pat_index = 0;
@@ -807,10 +814,20 @@ pattern_cache_choose_all(gx_color_tile * ctile, void *proc_data)
 {
     return true;
 }
+static void pattern_cache_discard_kept(gx_pattern_cache *, gx_color_tile *);
 static void
 pattern_cache_free_all(gx_pattern_cache * pcache)
 {
+    uint i;
+
     gx_pattern_cache_winnow(pcache, pattern_cache_choose_all, NULL);
+    /* This is called before a restore, which may free the clist devices */
+    /* (they are allocated from the interpreter's memory), so only */
+    /* bitmaps (which come from the cache's memory) can be kept. */
+    if (pcache->kept != NULL)
+        for (i = 0; i < pcache->num_kept; i++)
+            if (pcache->kept[i].cdev != NULL)
+                pattern_cache_discard_kept(pcache, &pcache->kept[i]);
 }
 
 /* Allocate a Pattern cache. */
@@ -839,6 +856,11 @@ gx_pattern_alloc_cache(gs_memory_t * mem, uint num_tiles, ulong max_bits)
     pcache->bits_used = 0;
     pcache->max_bits = max_bits;
     pcache->free_all = pattern_cache_free_all;
+    pcache->kept = NULL;
+    pcache->num_kept = 0;
+    pcache->kept_next = 0;
+    pcache->kept_bits = 0;
+    pcache->pending_id = gx_no_bitmap_id;
     for (i = 0; i < num_tiles; tiles++, i++) {
         tiles->id = gx_no_bitmap_id;
         /* Clear the pointers to pacify the GC. */
@@ -865,6 +887,7 @@ gx_pattern_alloc_cache(gs_memory_t * mem, uint num_tiles, ulong max_bits)
         tiles->cdev = NULL;
         tiles->ttrans = NULL;
         tiles->num_planar_planes = 0;
+        tiles->has_content_key = false;
     }
     return pcache;
 }
@@ -891,6 +914,14 @@ gx_pattern_cache_free(gx_pattern_cache *pcache)
 {
     if (pcache == NULL)
         return;
+    if (pcache->kept != NULL) {
+        uint i;
+
+        for (i = 0; i < pcache->num_kept; i++)
+            pattern_cache_discard_kept(pcache, &pcache->kept[i]);
+        gs_free_object(pcache->memory, pcache->kept, "gx_pattern_cache_free");
+        pcache->kept = NULL;
+    }
     pattern_cache_free_all(pcache);
     gs_free_object(pcache->memory, pcache->tiles, "gx_pattern_cache_free");
     pcache->tiles = NULL;
@@ -909,82 +940,143 @@ gstate_set_pattern_cache(gs_gstate * pgs, gx_pattern_cache * pcache)
     pgs->pattern_cache = pcache;
 }
 
-/* Free a Pattern cache entry. */
-/* This will not free a pattern if it is 'locked' which should only be for */
-/* a stroke pattern during fill_stroke_path.                               */
+/* Free the data of a Pattern tile. */
 static void
-gx_pattern_cache_free_entry(gx_pattern_cache * pcache, gx_color_tile * ctile)
+pattern_tile_free_data(gx_pattern_cache * pcache, gx_color_tile * ctile)
 {
     gx_device *temp_device;
+    gs_memory_t *mem = pcache->memory;
 
-    if ((ctile->id != gx_no_bitmap_id) && !ctile->is_dummy && !ctile->is_locked) {
-        gs_memory_t *mem = pcache->memory;
+    /*
+     * We must initialize the memory device properly, even though
+     * we aren't using it for drawing.
+     */
+    if (ctile->tmask.data != 0) {
+        gs_free_object(mem, ctile->tmask.data,
+                       "free_pattern_cache_entry(mask data)");
+        ctile->tmask.data = 0;      /* for GC */
+    }
+    if (ctile->tbits.data != 0) {
+        gs_free_object(mem, ctile->tbits.data,
+                       "free_pattern_cache_entry(bits data)");
+        ctile->tbits.data = 0;      /* for GC */
+    }
+    if (ctile->cdev != NULL) {
+        ctile->cdev->common.do_not_open_or_close_bandfiles = false;  /* make sure memfile gets freed/closed */
+        dev_proc(&ctile->cdev->common, close_device)((gx_device *)&ctile->cdev->common);
+        /* Free up the icc based stuff in the clist device.  I am puzzled
+           why the other objects are not released */
+        clist_free_icc_table(ctile->cdev->common.icc_table,
+                        ctile->cdev->common.memory);
+        ctile->cdev->common.icc_table = NULL;
+        rc_decrement(ctile->cdev->common.icc_cache_cl,
+                        "gx_pattern_cache_free_entry");
+        ctile->cdev->common.icc_cache_cl = NULL;
+        ctile->cdev->writer.pinst = NULL;
+        gs_free_object(ctile->cdev->common.memory->non_gc_memory, ctile->cdev->common.cache_chunk, "free tile cache for clist");
+        ctile->cdev->common.cache_chunk = 0;
+        temp_device = (gx_device *)ctile->cdev;
+        gx_device_retain(temp_device, false);
+        ctile->cdev = NULL;
+    }
 
-        /*
-         * We must initialize the memory device properly, even though
-         * we aren't using it for drawing.
-         */
-        if (ctile->tmask.data != 0) {
-            gs_free_object(mem, ctile->tmask.data,
-                           "free_pattern_cache_entry(mask data)");
-            ctile->tmask.data = 0;      /* for GC */
-        }
-        if (ctile->tbits.data != 0) {
-            gs_free_object(mem, ctile->tbits.data,
-                           "free_pattern_cache_entry(bits data)");
-            ctile->tbits.data = 0;      /* for GC */
-        }
-        if (ctile->cdev != NULL) {
-            ctile->cdev->common.do_not_open_or_close_bandfiles = false;  /* make sure memfile gets freed/closed */
-            dev_proc(&ctile->cdev->common, close_device)((gx_device *)&ctile->cdev->common);
-            /* Free up the icc based stuff in the clist device.  I am puzzled
-               why the other objects are not released */
-            clist_free_icc_table(ctile->cdev->common.icc_table,
-                            ctile->cdev->common.memory);
-            ctile->cdev->common.icc_table = NULL;
-            rc_decrement(ctile->cdev->common.icc_cache_cl,
-                            "gx_pattern_cache_free_entry");
-            ctile->cdev->common.icc_cache_cl = NULL;
-            ctile->cdev->writer.pinst = NULL;
-            gs_free_object(ctile->cdev->common.memory->non_gc_memory, ctile->cdev->common.cache_chunk, "free tile cache for clist");
-            ctile->cdev->common.cache_chunk = 0;
-            temp_device = (gx_device *)ctile->cdev;
+    if (ctile->ttrans != NULL) {
+        if_debug2m('v', mem,
+                   "[v*] Freeing trans pattern from cache, uid = %ld id = %ld\n",
+                   ctile->uid.id, ctile->id);
+        if ( ctile->ttrans->pdev14 == NULL) {
+            /* This can happen if we came from the clist */
+            if (ctile->ttrans->mem != NULL)
+                gs_free_object(ctile->ttrans->mem ,ctile->ttrans->transbytes,
+                               "free_pattern_cache_entry(transbytes)");
+            gs_free_object(mem,ctile->ttrans->fill_trans_buffer,
+                            "free_pattern_cache_entry(fill_trans_buffer)");
+            ctile->ttrans->transbytes = NULL;
+            ctile->ttrans->fill_trans_buffer = NULL;
+        } else {
+            dev_proc(ctile->ttrans->pdev14, close_device)((gx_device *)ctile->ttrans->pdev14);
+            temp_device = (gx_device *)(ctile->ttrans->pdev14);
             gx_device_retain(temp_device, false);
-            ctile->cdev = NULL;
+            rc_decrement(temp_device,"gx_pattern_cache_free_entry");
+            ctile->ttrans->pdev14 = NULL;
+            ctile->ttrans->transbytes = NULL;  /* should be ok due to pdf14_close */
+            ctile->ttrans->fill_trans_buffer = NULL; /* This is always freed */
         }
 
-        if (ctile->ttrans != NULL) {
-            if_debug2m('v', mem,
-                       "[v*] Freeing trans pattern from cache, uid = %ld id = %ld\n",
-                       ctile->uid.id, ctile->id);
-            if ( ctile->ttrans->pdev14 == NULL) {
-                /* This can happen if we came from the clist */
-                if (ctile->ttrans->mem != NULL)
-                    gs_free_object(ctile->ttrans->mem ,ctile->ttrans->transbytes,
-                                   "free_pattern_cache_entry(transbytes)");
-                gs_free_object(mem,ctile->ttrans->fill_trans_buffer,
-                                "free_pattern_cache_entry(fill_trans_buffer)");
-                ctile->ttrans->transbytes = NULL;
-                ctile->ttrans->fill_trans_buffer = NULL;
-            } else {
-                dev_proc(ctile->ttrans->pdev14, close_device)((gx_device *)ctile->ttrans->pdev14);
-                temp_device = (gx_device *)(ctile->ttrans->pdev14);
-                gx_device_retain(temp_device, false);
-                rc_decrement(temp_device,"gx_pattern_cache_free_entry");
-                ctile->ttrans->pdev14 = NULL;
-                ctile->ttrans->transbytes = NULL;  /* should be ok due to pdf14_close */
-                ctile->ttrans->fill_trans_buffer = NULL; /* This is always freed */
-            }
+        gs_free_object(mem, ctile->ttrans,
+                       "free_pattern_cache_entry(ttrans)");
+        ctile->ttrans = NULL;
 
-            gs_free_object(mem, ctile->ttrans,
-                           "free_pattern_cache_entry(ttrans)");
-            ctile->ttrans = NULL;
+    }
+}
 
-        }
+/* Discard a kept tile. */
+static void
+pattern_cache_discard_kept(gx_pattern_cache * pcache, gx_color_tile * ktile)
+{
+    if (ktile->id != gx_no_bitmap_id) {
+        pattern_tile_free_data(pcache, ktile);
+        pcache->kept_bits -= ktile->bits_used;
+        ktile->id = gx_no_bitmap_id;
+        ktile->has_content_key = false;
+    }
+}
+
+static uint
+pattern_cache_kept_index(const gx_pattern_cache * pcache, const byte *key)
+{
+    return ((uint)key[0] | ((uint)key[1] << 8) | ((uint)key[2] << 16)) % pcache->num_kept;
+}
+
+/*
+ * Move the data of a tile that is being freed into the kept table, if
+ * we can identify its content and it fits the budget.  Returns true if
+ * the data has gone.
+ */
+static bool
+pattern_cache_keep_entry(gx_pattern_cache * pcache, gx_color_tile * ctile)
+{
+    size_t budget = pcache->memory->gs_lib_ctx->core->pattern_tile_cache;
+    gx_color_tile *ktile;
+    uint index;
+
+    if (pcache->kept == NULL || !ctile->has_content_key ||
+        ctile->ttrans != NULL || (size_t)ctile->bits_used > budget)
+        return false;
+    ktile = &pcache->kept[pattern_cache_kept_index(pcache, ctile->content_key)];
+    pattern_cache_discard_kept(pcache, ktile);
+    /* Make room by discarding the oldest, as gx_pattern_cache_ensure_space does. */
+    while (pcache->kept_bits + ctile->bits_used > budget) {
+        pcache->kept_next = (pcache->kept_next + 1) % pcache->num_kept;
+        pattern_cache_discard_kept(pcache, &pcache->kept[pcache->kept_next]);
+    }
+    index = ktile->index;
+    *ktile = *ctile;
+    ktile->index = index;
+    /* The instance (and so the uid's XUID values) may go before the tile. */
+    uid_set_invalid(&ktile->uid);
+    if (ktile->cdev != NULL)
+        ktile->cdev->writer.pinst = NULL;
+    pcache->kept_bits += ktile->bits_used;
+    ctile->tbits.data = 0;
+    ctile->tmask.data = 0;
+    ctile->cdev = NULL;
+    return true;
+}
 
+/* Free a Pattern cache entry. */
+/* This will not free a pattern if it is 'locked' which should only be for */
+/* a stroke pattern during fill_stroke_path.                               */
+static void
+gx_pattern_cache_free_entry(gx_pattern_cache * pcache, gx_color_tile * ctile)
+{
+    if ((ctile->id != gx_no_bitmap_id) && !ctile->is_dummy && !ctile->is_locked) {
+        if (!pattern_cache_keep_entry(pcache, ctile))
+            pattern_tile_free_data(pcache, ctile);
         pcache->tiles_used--;
         pcache->bits_used -= ctile->bits_used;
         ctile->id = gx_no_bitmap_id;
+        ctile->has_content_key = false;
     }
 }
 
@@ -1180,6 +1272,12 @@ gx_pattern_cache_add_entry(gs_gstate * pgs,
     ctile->has_overlap = pinst->has_overlap;
     ctile->is_dummy = false;
     ctile->is_locked = false;
+    /* See gx_pattern_load. */
+    ctile->has_content_key = (pcache->pending_id == id);
+    if (ctile->has_content_key) {
+        memcpy(ctile->content_key, pcache->pending_key, sizeof(ctile->content_key));
+        pcache->pending_id = gx_no_bitmap_id;
+    }
     ctile->blending_mode = 0;
     ctile->trans_group_popped = false;
     if (dev_proc(fdev, open_device) != pattern_clist_open_device) {
@@ -1258,6 +1356,7 @@ gx_pattern_cache_get_entry(gs_gstate * pgs, gs_id id, gx_color_tile ** pctile)
     ctile = gx_pattern_cache_find_tile_for_id(pcache, id);
     gx_pattern_cache_free_entry(pgs->pattern_cache, ctile);
     ctile->id = id;
+    ctile->has_content_key = false;
     *pctile = ctile;
     return 0;
 }
@@ -1294,6 +1393,7 @@ gx_pattern_cache_add_dummy_entry(gs_gstate *pgs,
     ctile->has_overlap = pinst->has_overlap;
     ctile->is_dummy = true;
     ctile->is_locked = false;
+    ctile->has_content_key = false;
     memset(&ctile->tbits, 0 , sizeof(ctile->tbits));
     ctile->tbits.size = pinst->size;
     ctile->tbits.id = gs_no_bitmap_id;
@@ -1479,6 +1579,287 @@ gx_erase_colored_pattern(gs_gstate *pgs)
     return code;
 }
 
+/* ------ Keeping tiles by content ------ */
+
+#define KEY_ADD(pmd5, v)\
+  gs_md5_append(pmd5, (const gs_md5_byte_t *)&(v), sizeof(v))
+
+static void
+pattern_key_add_id(gs_md5_state_t *pmd5, gs_id id)
+{
+    KEY_ADD(pmd5, id);
+}
+
+static bool
+pattern_key_add_profile(gs_md5_state_t *pmd5, cmm_profile_t *profile)
+{
+    int64_t hash = 0;
+
+    if (profile != NULL) {
+        if (!profile->hash_is_valid && profile->buffer == NULL)
+            return false;
+        hash = gsicc_get_hash(profile);
+    }
+    KEY_ADD(pmd5, hash);
+    return true;
+}
+
+static bool
+pattern_key_add_color(gs_md5_state_t *pmd5, const gs_gstate_color *pcolor)
+{
+    const gs_color_space *pcs = pcolor->color_space;
+    gs_color_space_index index;
+    int i, n;
+
+    if (pcs == NULL || pcolor->ccolor == NULL)
+        return true;
+    index = gs_color_space_get_index(pcs);
+    switch (index) {
+        case gs_color_space_index_DeviceGray:
+        case gs_color_space_index_DeviceRGB:
+        case gs_color_space_index_DeviceCMYK:
+        case gs_color_space_index_ICC:
+            break;
+        default:
+            return false;
+    }
+    KEY_ADD(pmd5, index);
+    if (!pattern_key_add_profile(pmd5, pcs->cmm_icc_profile_data))
+        return false;
+    n = cs_num_components(pcs);
+    for (i = 0; i < n; i++)
+        KEY_ADD(pmd5, pcolor->ccolor->paint.values[i]);
+    return true;
+}
+
+/*
+ * Compute the key under which a tile for the instance can be kept:
+ * what the PaintProc draws (from the template's ContentDigest, or else
+ * its UniqueID or XUID, which are unique by definition), and everything
+ * about the saved graphics state and the device that affects how it is
+ * rendered.  The translation of the saved CTM is set so that the tile
+ * starts at the origin, so instances that differ only by a translation
+ * share a key.  Returns false if the tile can't be kept.
+ */
+static bool
+gx_pattern_content_key(const gs_pattern1_instance_t *pinst,
+                       gx_device *dev, bool has_tags, byte *key)
+{
+    const gs_pattern1_template_t *ptemp = &pinst->templat;
+    const gs_gstate *saved = pinst->saved;
+    const gx_line_params *plp = &saved->line_params;
+    gx_device *tdev = saved->device;
+    gs_md5_state_t md5;
+    byte digest[16];
+    gs_matrix ctm = ctm_only(saved);
+    const char *dname = dev->dname;
+    dev_proc_encode_color((*encode_color)) = dev_proc(dev, encode_color);
+    uint i;
+
+    /* Transparency needs the pdf14 buffers, which we don't keep, and */
+    /* high level devices manage the Patterns themselves. */
+    if (ptemp->uses_transparency || ptemp->BM_Not_Normal ||
+        dev_proc(tdev, dev_spec_op)(tdev, gxdso_pattern_can_accum,
+                                    (void *)pinst, 0) == 1)
+        return false;
+    gs_md5_init(&md5);
+    if (ptemp->ContentDigest != NULL) {
+        gs_client_color cc;
+
+        cc.pattern = (gs_pattern_instance_t *)pinst;
+        if ((*ptemp->ContentDigest)(&cc, digest) != 1)
+            return false;
+        gs_md5_append(&md5, (const gs_md5_byte_t *)"D", 1);
+        gs_md5_append(&md5, digest, sizeof(digest));
+    } else if (uid_is_valid(&ptemp->uid)) {
+        gs_md5_append(&md5, (const gs_md5_byte_t *)"U", 1);
+        KEY_ADD(&md5, ptemp->uid.id);
+        if (uid_is_XUID(&ptemp->uid))
+            gs_md5_append(&md5, (const gs_md5_byte_t *)uid_XUID_values(&ptemp->uid),
+                          uid_XUID_size(&ptemp->uid) * sizeof(long));
+    } else
+        return false;
+
+    /* The template and the instance */
+    KEY_ADD(&md5, ptemp->PaintType);
+    KEY_ADD(&md5, ptemp->TilingType);
+    KEY_ADD(&md5, ptemp->BBox);
+    KEY_ADD(&md5, ptemp->XStep);
+    KEY_ADD(&md5, ptemp->YStep);
+    KEY_ADD(&md5, pinst->size);
+    KEY_ADD(&md5, pinst->step_matrix.xx);
+    KEY_ADD(&md5, pinst->step_matrix.xy);
+    KEY_ADD(&md5, pinst->step_matrix.yx);
+    KEY_ADD(&md5, pinst->step_matrix.yy);
+    KEY_ADD(&md5, pinst->is_simple);
+    KEY_ADD(&md5, pinst->uses_mask);
+    KEY_ADD(&md5, pinst->is_clist);
+
+    /* The saved graphics state */
+    KEY_ADD(&md5, ctm);
+    KEY_ADD(&md5, plp->half_width);
+    KEY_ADD(&md5, plp->start_cap);
+    KEY_ADD(&md5, plp->end_cap);
+    KEY_ADD(&md5, plp->dash_cap);
+    KEY_ADD(&md5, plp->join);
+    KEY_ADD(&md5, plp->curve_join);
+    KEY_ADD(&md5, plp->miter_limit);
+    KEY_ADD(&md5, plp->dot_length);
+    KEY_ADD(&md5, plp->dot_length_absolute);
+    KEY_ADD(&md5, plp->dot_orientation);
+    KEY_ADD(&md5, plp->dash.pattern_size);
+    if (plp->dash.pattern_size > 0)
+        gs_md5_append(&md5, (const gs_md5_byte_t *)plp->dash.pattern,
+                      plp->dash.pattern_size * sizeof(float));
+    KEY_ADD(&md5, plp->dash.offset);
+    KEY_ADD(&md5, plp->dash.adapt);
+    KEY_ADD(&md5, saved->log_op);
+    KEY_ADD(&md5, saved->blend_mode);
+    KEY_ADD(&md5, saved->soft_mask_id);
+    KEY_ADD(&md5, saved->text_knockout);
+    KEY_ADD(&md5, saved->text_rendering_mode);
+    KEY_ADD(&md5, saved->overprint);
+    KEY_ADD(&md5, saved->overprint_mode);
+    KEY_ADD(&md5, saved->stroke_overprint);
+    KEY_ADD(&md5, saved->flatness);
+    KEY_ADD(&md5, saved->fill_adjust);
+    KEY_ADD(&md5, saved->stroke_adjust);
+    KEY_ADD(&md5, saved->accurate_curves);
+    KEY_ADD(&md5, saved->smoothness);
+    KEY_ADD(&md5, saved->renderingintent);
+    KEY_ADD(&md5, saved->blackptcomp);
+    KEY_ADD(&md5, saved->strokeconstantalpha);
+    KEY_ADD(&md5, saved->fillconstantalpha);
+    KEY_ADD(&md5, saved->alphaisshape);
+    KEY_ADD(&md5, saved->textspacing);
+    KEY_ADD(&md5, saved->textleading);
+    KEY_ADD(&md5, saved->textrise);
+    KEY_ADD(&md5, saved->wordspacing);
+    KEY_ADD(&md5, saved->texthscaling);
+    KEY_ADD(&md5, saved->PDFfontsize);
+    KEY_ADD(&md5, saved->textlinematrix);
+    KEY_ADD(&md5, saved->textmatrix);
+    pattern_key_add_id(&md5, saved->font != NULL ? saved->font->id : gs_no_id);
+    /* PDF interpreters install a new halftone for each page, which only */
+    /* matters to devices that use it. */
+    if (gx_device_must_halftone(dev)) {
+        KEY_ADD(&md5, saved->screen_phase);
+        for (i = 0; i < HT_OBJTYPE_COUNT; i++)
+            pattern_key_add_id(&md5, saved->dev_ht[i] != NULL ? saved->dev_ht[i]->id : gs_no_id);
+    }
+    pattern_key_add_id(&md5, saved->cie_render != NULL ? saved->cie_render->id : gs_no_id);
+    pattern_key_add_id(&md5, saved->black_generation != NULL ? saved->black_generation->id : gs_no_id);
+    pattern_key_add_id(&md5, saved->undercolor_removal != NULL ? saved->undercolor_removal->id : gs_no_id);
+    for (i = 0; i < GX_DEVICE_COLOR_MAX_COMPONENTS; i++)
+        pattern_key_add_id(&md5, saved->effective_transfer[i] != NULL ? saved->effective_transfer[i]->id : gs_no_id);
+    if (ptemp->PaintType == 1 &&
+        (!pattern_key_add_color(&md5, &saved->color[0]) ||
+         !pattern_key_add_color(&md5, &saved->color[1])))
+        return false;
+    if (saved->icc_manager != NULL &&
+        (!pattern_key_add_profile(&md5, saved->icc_manager->default_gray) ||
+         !pattern_key_add_profile(&md5, saved->icc_manager->default_rgb) ||
+         !pattern_key_add_profile(&md5, saved->icc_manager->default_cmyk)))
+        return false;
+
+    /* The device the tile is rendered for */
+    gs_md5_append(&md5, (const gs_md5_byte_t *)dname, strlen(dname));
+    KEY_ADD(&md5, encode_color);
+    KEY_ADD(&md5, dev->color_info.num_components);
+    KEY_ADD(&md5, dev->color_info.polarity);
+    KEY_ADD(&md5, dev->color_info.gray_index);
+    KEY_ADD(&md5, dev->color_info.depth);
+    KEY_ADD(&md5, dev->color_info.max_gray);
+    KEY_ADD(&md5, dev->color_info.max_color);
+    KEY_ADD(&md5, dev->color_info.dither_grays);
+    KEY_ADD(&md5, dev->color_info.dither_colors);
+    KEY_ADD(&md5, dev->color_info.anti_alias);
+    KEY_ADD(&md5, dev->HWResolution);
+    KEY_ADD(&md5, dev->graphics_type_tag);
+    KEY_ADD(&md5, has_tags);
+    if (dev->icc_struct != NULL &&
+        !pattern_key_add_profile(&md5, dev->icc_struct->device_profile[GS_DEFAULT_DEVICE_PROFILE]))
+        return false;
+    KEY_ADD(&md5, tdev->num_planar_planes);
+    KEY_ADD(&md5, tdev->MaxPatternBitmap);
+    gs_md5_finish(&md5, key);
+    return true;
+}
+
+/* Look for a kept tile for the instance. If there is one, move it into */
+/* the cache under the instance's id and return 1, otherwise return 0. */
+static int
+pattern_cache_revive(gs_gstate * pgs, gs_pattern1_instance_t *pinst, const byte *key)
+{
+    gx_pattern_cache *pcache = pgs->pattern_cache;
+    gx_color_tile *ktile;
+    gx_color_tile *ctile;
+    gx_color_tile tile;
+    uint index;
+
+    if (pcache->kept == NULL) {
+        gx_color_tile *kept =
+            gs_alloc_struct_array(pcache->memory, pcache->num_tiles, gx_color_tile,
+                                  &st_color_tile_element,
+                                  "pattern_cache_revive(kept)");
+
+        if (kept == NULL)
+            return 0;
+        for (index = 0; index < pcache->num_tiles; index++) {
+            memset(&kept[index], 0, sizeof(kept[index]));
+            kept[index].id = gx_no_bitmap_id;
+            uid_set_invalid(&kept[index].uid);
+            kept[index].index = index;
+        }
+        pcache->kept = kept;
+        pcache->num_kept = pcache->num_tiles;
+        pcache->kept_next = 0;
+        pcache->kept_bits = 0;
+    }
+    ktile = &pcache->kept[pattern_cache_kept_index(pcache, key)];
+    if (ktile->id == gx_no_bitmap_id || memcmp(ktile->content_key, key, sizeof(ktile->content_key))) {
+        gx_stats_count(pgs->memory, gx_stats_pattern_kept_miss);
+        return 0;
+    }
+    /* Take it out of the kept table first, as making room may add to it. */
+    tile = *ktile;
+    ktile->id = gx_no_bitmap_id;
+    ktile->has_content_key = false;
+    ktile->tbits.data = 0;
+    ktile->tmask.data = 0;
+    ktile->cdev = NULL;
+    pcache->kept_bits -= tile.bits_used;
+
+    gx_pattern_cache_ensure_space(pgs, tile.bits_used);
+    ctile = gx_pattern_cache_find_tile_for_id(pcache, pinst->id);
+    gx_pattern_cache_free_entry(pcache, ctile);
+    index = ctile->index;
+    *ctile = tile;
+    ctile->index = index;
+    /* The rest of the 'key' and the placement come from the instance. */
+    ctile->id = pinst->id;
+    ctile->uid = pinst->templat.uid;
+    ctile->tiling_type = pinst->templat.TilingType;
+    ctile->step_matrix = pinst->step_matrix;
+    ctile->bbox = pinst->bbox;
+    ctile->is_simple = pinst->is_simple;
+    ctile->has_overlap = pinst->has_overlap;
+    ctile->is_dummy = false;
+    ctile->is_locked = false;
+    ctile->blending_mode = 0;
+    ctile->trans_group_popped = false;
+    /* Bitmap ids mustn't be reused for different placements. */
+    if (ctile->tbits.data != 0)
+        ctile->tbits.id = gs_next_ids(pgs->memory, 1);
+    if (ctile->tmask.data != 0)
+        ctile->tmask.id = pinst->id;
+    if (ctile->cdev != NULL)
+        ctile->cdev->writer.pinst = pinst;
+    gx_pattern_cache_update_used(pgs, tile.bits_used);
+    gx_stats_count(pgs->memory, gx_stats_pattern_kept_hit);
+    return 1;
+}
+
 /* Reload a (non-null) Pattern color into the cache. */
 /* *pdc is already set, except for colors.pattern.p_tile and mask.m_tile. */
 int
@@ -1492,6 +1873,8 @@ gx_pattern_load(gx_device_color * pdc, const gs_gstate * pgs,
     gx_color_tile *ctile;
     gs_memory_t *mem = pgs->memory;
     bool has_tags = device_encodes_tags(dev);
+    byte key[16];
+    bool keyed = false;
     int code;
 
     if (pgs->pattern_cache == NULL)
@@ -1501,6 +1884,26 @@ gx_pattern_load(gx_device_color * pdc, const gs_gstate * pgs,
     if (gx_pattern_cache_lookup(pdc, pgs, dev, select))
         return 0;
 
+    /* See if we have kept a tile with the same content. */
+    pgs->pattern_cache->pending_id = gx_no_bitmap_id;
+    if (pgs->pattern_cache->memory->gs_lib_ctx->core->pattern_tile_cache != 0) {
+        keyed = gx_pattern_content_key(pinst, dev, has_tags, key);
+        if (keyed && pattern_cache_revive((gs_gstate *)pgs, pinst, key)) {
+            if (!gx_pattern_cache_lookup(pdc, pgs, dev, select)) {
+                mlprintf(mem, "Pattern cache lookup failed after insertion!\n");
+                return_error(gs_error_Fatal);
+            }
+            return 0;
+        }
+        /* If the PaintProc hands the rendering back to the interpreter */
+        /* (as PostScript's does), the tile is added by the interpreter, */
+        /* and is rendered for the saved device. */
+        if (keyed && dev == pinst->saved->device) {
+            pgs->pattern_cache->pending_id = pinst->id;
+            memcpy(pgs->pattern_cache->pending_key, key, sizeof(key));
+        }
+    }
+
     /* Get enough space in the cache for this pattern (estimated if it is a clist) */
     gx_pattern_cache_ensure_space((gs_gstate *)pgs, gx_pattern_size_estimate(pinst, has_tags));
     /*
@@ -1605,6 +2008,10 @@ gx_pattern_load(gx_device_color * pdc, const gs_gstate * pgs,
     code = gx_pattern_cache_add_entry((gs_gstate *)pgs,
                 adev, &ctile);
     if (code >= 0) {
+        if (keyed) {
+            memcpy(ctile->content_key, key, sizeof(ctile->content_key));
+            ctile->has_content_key = true;
+        }
         if (!gx_pattern_cache_lookup(pdc, pgs, dev, select)) {
             mlprintf(mem, "Pattern cache lookup failed after insertion!\n");
             code = gs_note_error(gs_error_Fatal);
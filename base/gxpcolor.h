@@ -193,6 +193,10 @@ struct gx_color_tile_s {
     /* We do, however, copy the template's gs_uid, */
     /* for use in selective cache purging. */
     gs_uid uid;
+    /* If has_content_key is set, content_key identifies what the */
+    /* tile holds, whatever instance it was rendered for, so that */
+    /* it can be kept for reuse (see gx_pattern_load). */
+    byte content_key[16];
     /* ------ The following are the cache 'value'. ------ */
     int bits_used;              /* The number of bits this uses in the cache */
     /* Note that if tbits and tmask both have data != 0, */
@@ -222,7 +226,8 @@ struct gx_color_tile_s {
                                    device which, is not planar but the target
                                    is */
     byte is_locked;		/* stroke patterns cannot be freed during fill_stroke_path */
-    byte pad[2];		/* structure members alignment. */
+    byte has_content_key;	/* true if content_key is set */
+    byte pad[1];		/* structure members alignment. */
     /* The following is neither key nor value. */
     uint index;			/* the index of the tile within the cache (for GC) */
 };
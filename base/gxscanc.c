@@ -133,6 +133,13 @@
  *
  * If we spot that each scanlines data has the same set of ids in the
  * same order, then we can 'collate' them into a trapezoid.
+ *
+ * The fifth set (gx_scan_convert_aa etc) is for antialiasing. Rather
+ * than intersections, each scanline gets a dense row of cells, and each
+ * edge adds the exact (signed) area it cuts off from every cell it
+ * passes through. Accumulating these across a row gives an 8 bit
+ * coverage value per pixel, so we can fill straight onto the device
+ * with rectangles and copy_alpha, with no oversampling.
  */
 
 /* NOTE: code in this file assumes that fixed and int can be used
@@ -4540,6 +4547,415 @@ rowdifferent:{}
 }
 
 
+/* Analytic coverage routines */
+
+/* The coverage table holds a (cover, area) pair for every pixel cell in
+ * the band. 'cover' is the signed height of the edges crossing the cell,
+ * and 'area' is (twice) the signed area of the cell to the left of those
+ * edges, both in fixed units. Summing the covers from the left edge of a
+ * row gives the winding coverage at each pixel, from which we subtract
+ * the area to get the exact coverage of the cells that edges pass
+ * through. */
+static inline void
+cell_aa(int *row, int width, int x, int cover, int area)
+{
+    if (x < width) {
+        row[2*x  ] += cover;
+        row[2*x+1] += area;
+    }
+}
+
+/* Add a piece of an edge that lies within a single scanline. x1 and x2
+ * are relative to the left of the band, y1 < y2 are relative to the top
+ * of the scanline. */
+static void
+mark_scanline_aa(int *row, int width, fixed x1, fixed y1, fixed x2, fixed y2, int dirn)
+{
+    int   ex1 = fixed2int(x1);
+    int   ex2 = fixed2int(x2);
+    int   fx1 = fixed_fraction(x1);
+    int   fx2 = fixed_fraction(x2);
+    int   first, incr, delta, mod, lift, rem;
+    fixed dx, p;
+
+    if (ex1 == ex2) {
+        cell_aa(row, width, ex1, dirn*(y2-y1), dirn*(fx1+fx2)*(y2-y1));
+        return;
+    }
+
+    /* Step across the cells, sharing out the height of the edge between
+     * them with a DDA. */
+    dx = x2 - x1;
+    if (dx > 0) {
+        p     = (fixed_1 - fx1) * (y2 - y1);
+        first = fixed_1;
+        incr  = 1;
+    } else {
+        p     = fx1 * (y2 - y1);
+        first = 0;
+        incr  = -1;
+        dx    = -dx;
+    }
+    delta = p / dx;
+    mod   = p % dx;
+    cell_aa(row, width, ex1, dirn*delta, dirn*(fx1+first)*delta);
+    y1  += delta;
+    ex1 += incr;
+    if (ex1 != ex2) {
+        p    = fixed_1 * (y2 - y1 + delta);
+        lift = p / dx;
+        rem  = p % dx;
+        mod -= dx;
+        do {
+            delta = lift;
+            mod  += rem;
+            if (mod >= 0) {
+                mod -= dx;
+                delta++;
+            }
+            cell_aa(row, width, ex1, dirn*delta, dirn*fixed_1*delta);
+            y1  += delta;
+            ex1 += incr;
+        } while (ex1 != ex2);
+    }
+    delta = y2 - y1;
+    cell_aa(row, width, ex2, dirn*delta, dirn*(fx2+fixed_1-first)*delta);
+}
+
+static void mark_line_aa(fixed sx, fixed sy, fixed ex, fixed ey, int base_y, int height, int xmin, int width, int *table)
+{
+    fixed left  = int2fixed(xmin);
+    fixed right = int2fixed(xmin + width);
+    int   dirn  = 1;
+    int   iy, iey;
+    fixed x0, y0, x1, y1;
+
+    if (sy == ey)
+        return;
+
+    /* Split the line where it crosses the sides of the band. */
+    if ((sx < left && ex > left) || (sx > left && ex < left)) {
+        fixed my = sy + (fixed)((fixed64)(ey - sy) * (left - sx) / (ex - sx));
+
+        mark_line_aa(sx, sy, left, my, base_y, height, xmin, width, table);
+        mark_line_aa(left, my, ex, ey, base_y, height, xmin, width, table);
+        return;
+    }
+    if ((sx < right && ex > right) || (sx > right && ex < right)) {
+        fixed my = sy + (fixed)((fixed64)(ey - sy) * (right - sx) / (ex - sx));
+
+        mark_line_aa(sx, sy, right, my, base_y, height, xmin, width, table);
+        mark_line_aa(right, my, ex, ey, base_y, height, xmin, width, table);
+        return;
+    }
+    /* Anything to the right of the band can't affect it. Anything to the
+     * left only contributes cover, so we can move it onto the left edge. */
+    if (sx >= right && ex >= right)
+        return;
+    if (sx <= left && ex <= left)
+        sx = ex = left;
+
+    if (sy > ey) {
+        fixed t;
+        t = sx; sx = ex; ex = t;
+        t = sy; sy = ey; ey = t;
+        dirn = -1;
+    }
+
+    iy  = fixed2int(sy) - base_y;
+    iey = fixed2int_ceiling(ey) - base_y;
+    if (iy >= height || iey <= 0)
+        return;
+    if (iy < 0)
+        iy = 0;
+    if (iey > height)
+        iey = height;
+
+    y0 = int2fixed(base_y + iy);
+    if (y0 <= sy) {
+        y0 = sy;
+        x0 = sx;
+    } else
+        x0 = sx + (fixed)((fixed64)(ex - sx) * (y0 - sy) / (ey - sy));
+    for (; iy < iey; iy++) {
+        y1 = int2fixed(base_y + iy + 1);
+        if (y1 >= ey) {
+            y1 = ey;
+            x1 = ex;
+        } else
+            x1 = sx + (fixed)((fixed64)(ex - sx) * (y1 - sy) / (ey - sy));
+        mark_scanline_aa(&table[iy * width * 2], width,
+                         x0 - left, y0 - int2fixed(base_y + iy),
+                         x1 - left, y1 - int2fixed(base_y + iy), dirn);
+        x0 = x1;
+        y0 = y1;
+    }
+}
+
+static void mark_curve_aa(fixed sx, fixed sy, fixed c1x, fixed c1y, fixed c2x, fixed c2y, fixed ex, fixed ey, int base_y, int height, int xmin, int width, int *table, int depth)
+{
+    fixed ax = (sx + c1x)>>1;
+    fixed ay = (sy + c1y)>>1;
+    fixed bx = (c1x + c2x)>>1;
+    fixed by = (c1y + c2y)>>1;
+    fixed cx = (c2x + ex)>>1;
+    fixed cy = (c2y + ey)>>1;
+    fixed dx = (ax + bx)>>1;
+    fixed dy = (ay + by)>>1;
+    fixed fx = (bx + cx)>>1;
+    fixed fy = (by + cy)>>1;
+    fixed gx = (dx + fx)>>1;
+    fixed gy = (dy + fy)>>1;
+
+    assert(depth >= 0);
+    if (depth == 0)
+        mark_line_aa(sx, sy, ex, ey, base_y, height, xmin, width, table);
+    else {
+        depth--;
+        mark_curve_aa(sx, sy, ax, ay, dx, dy, gx, gy, base_y, height, xmin, width, table, depth);
+        mark_curve_aa(gx, gy, fx, fy, cx, cy, ex, ey, base_y, height, xmin, width, table, depth);
+    }
+}
+
+static void mark_curve_big_aa(fixed64 sx, fixed64 sy, fixed64 c1x, fixed64 c1y, fixed64 c2x, fixed64 c2y, fixed64 ex, fixed64 ey, int base_y, int height, int xmin, int width, int *table, int depth)
+{
+    fixed64 ax = (sx + c1x)>>1;
+    fixed64 ay = (sy + c1y)>>1;
+    fixed64 bx = (c1x + c2x)>>1;
+    fixed64 by = (c1y + c2y)>>1;
+    fixed64 cx = (c2x + ex)>>1;
+    fixed64 cy = (c2y + ey)>>1;
+    fixed64 dx = (ax + bx)>>1;
+    fixed64 dy = (ay + by)>>1;
+    fixed64 fx = (bx + cx)>>1;
+    fixed64 fy = (by + cy)>>1;
+    fixed64 gx = (dx + fx)>>1;
+    fixed64 gy = (dy + fy)>>1;
+
+    assert(depth >= 0);
+    if (depth == 0)
+        mark_line_aa((fixed)sx, (fixed)sy, (fixed)ex, (fixed)ey, base_y, height, xmin, width, table);
+    else {
+        depth--;
+        mark_curve_big_aa(sx, sy, ax, ay, dx, dy, gx, gy, base_y, height, xmin, width, table, depth);
+        mark_curve_big_aa(gx, gy, fx, fy, cx, cy, ex, ey, base_y, height, xmin, width, table, depth);
+    }
+}
+
+static void mark_curve_top_aa(fixed sx, fixed sy, fixed c1x, fixed c1y, fixed c2x, fixed c2y, fixed ex, fixed ey, int base_y, int height, int xmin, int width, int *table, int depth)
+{
+    fixed test = (sx^(sx<<1))|(sy^(sy<<1))|(c1x^(c1x<<1))|(c1y^(c1y<<1))|(c2x^(c2x<<1))|(c2y^(c2y<<1))|(ex^(ex<<1))|(ey^(ey<<1));
+
+    if (test < 0)
+        mark_curve_big_aa(sx, sy, c1x, c1y, c2x, c2y, ex, ey, base_y, height, xmin, width, table, depth);
+    else
+        mark_curve_aa(sx, sy, c1x, c1y, c2x, c2y, ex, ey, base_y, height, xmin, width, table, depth);
+}
+
+int gx_scan_convert_aa(gx_device     * gs_restrict pdev,
+                       gx_path       * gs_restrict path,
+                 const gs_fixed_rect * gs_restrict clip,
+                       gx_edgebuffer * gs_restrict edgebuffer,
+                       fixed                       fixed_flat)
+{
+    gs_fixed_rect  ibox;
+    gs_fixed_rect  bbox;
+    int            scanlines, width;
+    const subpath *psub;
+    int           *table;
+    int64_t        size;
+    int            code;
+
+    edgebuffer->index = NULL;
+    edgebuffer->table = NULL;
+
+    /* Bale out if no actual path. We see this with the clist */
+    if (path->first_subpath == NULL)
+        return 0;
+
+    code = make_bbox(path, clip, &bbox, &ibox, 0);
+    if (code < 0)
+        return code;
+
+    /* make_bbox only clips in y. */
+    if (clip) {
+        if (ibox.p.x < fixed2int(clip->p.x))
+            ibox.p.x = fixed2int(clip->p.x);
+        if (ibox.q.x > fixed2int_ceiling(clip->q.x))
+            ibox.q.x = fixed2int_ceiling(clip->q.x);
+    }
+    if (ibox.q.y <= ibox.p.y || ibox.q.x <= ibox.p.x)
+        return 0;
+
+    if (pdev->max_fill_band != 0)
+        ibox.p.y &= ~(pdev->max_fill_band-1);
+    scanlines = ibox.q.y - ibox.p.y;
+    width     = ibox.q.x - ibox.p.x;
+
+    /* Keep the table to 1Meg where we can, as for the other routines. */
+    size = (int64_t)scanlines * width * 2 * sizeof(*table);
+    if (scanlines > 16 && size > 1024*1024)
+        return (int)(size/(1024*1024)) + 1;
+    if (size != (int64_t)(uint)size)
+        return_error(gs_error_VMerror);
+
+    table = (int *)gs_alloc_bytes(pdev->memory, size,
+                                  "scanc intersects buffer");
+    if (table == NULL)
+        return_error(gs_error_VMerror);
+    memset(table, 0, size);
+
+    for (psub = path->first_subpath; psub != 0;) {
+        const segment *pseg = (const segment *)psub;
+        fixed ex = pseg->pt.x;
+        fixed ey = pseg->pt.y;
+        fixed ix = ex;
+        fixed iy = ey;
+
+        while ((pseg = pseg->next) != 0 &&
+               pseg->type != s_start
+            ) {
+            fixed sx = ex;
+            fixed sy = ey;
+            ex = pseg->pt.x;
+            ey = pseg->pt.y;
+
+            switch (pseg->type) {
+                default:
+                case s_start: /* Should never happen */
+                case s_dash:  /* We should never be seeing a dash here */
+                    assert("This should never happen" == NULL);
+                    break;
+                case s_curve: {
+                    const curve_segment *const pcur = (const curve_segment *)pseg;
+                    int k = gx_curve_log2_samples(sx, sy, pcur, fixed_flat);
+
+                    mark_curve_top_aa(sx, sy, pcur->p1.x, pcur->p1.y, pcur->p2.x, pcur->p2.y, ex, ey, ibox.p.y, scanlines, ibox.p.x, width, table, k);
+                    break;
+                }
+                case s_gap:
+                case s_line:
+                case s_line_close:
+                    if (sy != ey)
+                        mark_line_aa(sx, sy, ex, ey, ibox.p.y, scanlines, ibox.p.x, width, table);
+                    break;
+            }
+        }
+        /* And close any open segments */
+        if (iy != ey)
+            mark_line_aa(ex, ey, ix, iy, ibox.p.y, scanlines, ibox.p.x, width, table);
+        psub = (const subpath *)pseg;
+    }
+
+    edgebuffer->base   = ibox.p.y;
+    edgebuffer->height = scanlines;
+    edgebuffer->xmin   = ibox.p.x;
+    edgebuffer->xmax   = ibox.q.x;
+    edgebuffer->table  = table;
+
+    return 0;
+}
+
+/* Turn the (cover, area) pairs into 8 bit coverage values according to
+ * the rule. The coverage values are packed down into the start of the
+ * table, one byte per pixel; the writes never overtake the reads. */
+int
+gx_filter_edgebuffer_aa(gx_device       * gs_restrict pdev,
+                        gx_edgebuffer   * gs_restrict edgebuffer,
+                        int                           rule)
+{
+    const int  full  = 1<<(2*_fixed_shift+1);
+    int        width = edgebuffer->xmax - edgebuffer->xmin;
+    const int *cell  = edgebuffer->table;
+    byte      *out   = (byte *)edgebuffer->table;
+    int        i, x;
+
+    for (i = 0; i < edgebuffer->height; i++) {
+        int cover = 0;
+
+        for (x = 0; x < width; x++) {
+            int v;
+
+            cover += *cell++;
+            v = (cover<<(_fixed_shift+1)) - *cell++;
+            if (v < 0)
+                v = -v;
+            if (rule == gx_rule_even_odd) {
+                v &= 2*full-1;
+                if (v > full)
+                    v = 2*full - v;
+            } else if (v > full)
+                v = full;
+            *out++ = (byte)((v*255 + (full>>1)) >> (2*_fixed_shift+1));
+        }
+    }
+    return 0;
+}
+
+/* Solid runs shorter than this are sent as part of the surrounding
+ * copy_alpha rather than as rectangles of their own. */
+#define AA_MIN_SOLID_RUN 4
+
+int
+gx_fill_edgebuffer_aa(gx_device       * gs_restrict pdev,
+                const gx_device_color * gs_restrict pdevc,
+                      gx_edgebuffer   * gs_restrict edgebuffer,
+                      int                           log_op)
+{
+    int width = edgebuffer->xmax - edgebuffer->xmin;
+    int i, code;
+
+    for (i = 0; i < edgebuffer->height; i++) {
+        const byte *row = (const byte *)edgebuffer->table + i * width;
+        int         y   = edgebuffer->base + i;
+        int         x   = 0;
+
+        while (x < width) {
+            int s;
+
+            if (row[x] == 0) {
+                x++;
+                continue;
+            }
+            s = x;
+            while (x < width && row[x] == 255)
+                x++;
+            if (x > s && (x - s >= AA_MIN_SOLID_RUN || x == width || row[x] == 0)) {
+                if (log_op < 0)
+                    code = dev_proc(pdev, fill_rectangle)(pdev, edgebuffer->xmin + s, y, x - s, 1, pdevc->colors.pure);
+                else
+                    code = gx_fill_rectangle_device_rop(edgebuffer->xmin + s, y, x - s, 1, pdevc, pdev, (gs_logical_operation_t)log_op);
+                if (code < 0)
+                    return code;
+                continue;
+            }
+            /* A partially covered span, running until we meet an empty
+             * pixel or a long enough solid run. */
+            while (x < width && row[x] != 0) {
+                int e = x;
+
+                while (e < width && row[e] == 255)
+                    e++;
+                if (e - x >= AA_MIN_SOLID_RUN)
+                    break;
+                x = (e > x ? e : x + 1);
+            }
+            if (color_is_pure(pdevc))
+                code = dev_proc(pdev, copy_alpha)(pdev, row, s, width, gx_no_bitmap_id,
+                                                  edgebuffer->xmin + s, y, x - s, 1,
+                                                  pdevc->colors.pure, 8);
+            else
+                code = dev_proc(pdev, copy_alpha_hl_color)(pdev, row, s, width, gx_no_bitmap_id,
+                                                           edgebuffer->xmin + s, y, x - s, 1,
+                                                           pdevc, 8);
+            if (code < 0)
+                return code;
+        }
+    }
+    return 0;
+}
+
+
 void
 gx_edgebuffer_init(gx_edgebuffer * edgebuffer)
 {
@@ -4587,6 +5003,13 @@ gx_scan_converter_t gx_scan_converter_tr_app =
     gx_fill_edgebuffer_tr_app
 };
 
+gx_scan_converter_t gx_scan_converter_aa =
+{
+    gx_scan_convert_aa,
+    gx_filter_edgebuffer_aa,
+    gx_fill_edgebuffer_aa
+};
+
 int
 gx_scan_convert_and_fill(const gx_scan_converter_t *sc,
                                gx_device       *dev,
@@ -134,10 +134,30 @@ gx_fill_edgebuffer_tr_app(gx_device       * gs_restrict pdev,
                           gx_edgebuffer   * gs_restrict edgebuffer,
                           int                           log_op);
 
+/* Analytic coverage (antialiasing) routines */
+int
+gx_scan_convert_aa(gx_device     * gs_restrict pdev,
+                   gx_path       * gs_restrict path,
+             const gs_fixed_rect * gs_restrict rect,
+                   gx_edgebuffer * gs_restrict edgebuffer,
+                   fixed                       flatness);
+
+int
+gx_filter_edgebuffer_aa(gx_device       * gs_restrict pdev,
+                        gx_edgebuffer   * gs_restrict edgebuffer,
+                        int                           rule);
+
+int
+gx_fill_edgebuffer_aa(gx_device       * gs_restrict pdev,
+                const gx_device_color * gs_restrict pdevc,
+                      gx_edgebuffer   * gs_restrict edgebuffer,
+                      int                           log_op);
+
 extern gx_scan_converter_t gx_scan_converter;
 extern gx_scan_converter_t gx_scan_converter_app;
 extern gx_scan_converter_t gx_scan_converter_tr;
 extern gx_scan_converter_t gx_scan_converter_tr_app;
+extern gx_scan_converter_t gx_scan_converter_aa;
 
 int
 gx_scan_convert_and_fill(const gx_scan_converter_t *sc,
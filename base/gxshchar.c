@@ -0,0 +1,358 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  39 Mesa Street, Suite 108A, San Francisco,
+   CA 94129, USA, for further information.
+*/
+
+
+/* Process wide glyph bitmap cache */
+#include "memory_.h"
+#include "gx.h"
+#include "gserrors.h"
+#include "gsmalloc.h"
+#include "gxsync.h"
+#include "globals.h"
+#include "gxstats.h"
+#include "gxshchar.h"
+
+#define SHARDS_LOG2 4
+#define NUM_SHARDS (1 << SHARDS_LOG2)
+#define MIN_BUCKETS 64
+
+/* The key and then the value follow the entry. */
+typedef struct shared_char_entry_s shared_char_entry_t;
+struct shared_char_entry_s {
+    shared_char_entry_t *next;          /* in the hash chain */
+    shared_char_entry_t *prev_used;     /* LRU list, most recent first */
+    shared_char_entry_t *next_used;
+    uint hash;
+    uint key_size;
+    uint value_size;
+    size_t size;                        /* the whole entry, for the budget */
+};
+
+#define ENTRY_KEY(e) ((byte *)((e) + 1))
+#define ENTRY_VALUE(e) (ENTRY_KEY(e) + (e)->key_size)
+
+typedef struct shared_char_shard_s {
+    gx_monitor_t *lock;
+    shared_char_entry_t **table;
+    uint table_mask;
+    uint count;
+    shared_char_entry_t *first_used;
+    shared_char_entry_t *last_used;
+    size_t bytes;
+    size_t max_bytes;
+} shared_char_shard_t;
+
+typedef struct gx_shared_char_cache_s {
+    gs_memory_t *memory;        /* our own malloc allocator */
+    int users;                  /* protected by the global lock */
+    size_t size;
+    shared_char_shard_t shards[NUM_SHARDS];
+} gx_shared_char_cache_t;
+
+#define CACHE(mem) ((gx_shared_char_cache_t *)(mem)->gs_lib_ctx->core->shared_char_cache)
+
+/* The top bits choose the shard, the bottom ones the bucket. */
+#define SHARD_INDEX(hash) (((hash) >> (32 - SHARDS_LOG2)) & (NUM_SHARDS - 1))
+
+static uint
+hash_key(const byte *key, uint key_size)
+{
+    /* FNV-1a */
+    uint hash = 2166136261u;
+    uint i;
+
+    for (i = 0; i < key_size; i++)
+        hash = ((hash ^ key[i]) * 16777619u) & 0xffffffffu;
+    return hash;
+}
+
+static shared_char_entry_t *
+find_entry(shared_char_shard_t *shard, uint hash, const byte *key, uint key_size)
+{
+    shared_char_entry_t *e = shard->table[hash & shard->table_mask];
+
+    for (; e != NULL; e = e->next)
+        if (e->hash == hash && e->key_size == key_size &&
+            !memcmp(ENTRY_KEY(e), key, key_size))
+            return e;
+    return NULL;
+}
+
+static void
+unlink_used(shared_char_shard_t *shard, shared_char_entry_t *e)
+{
+    if (e->prev_used != NULL)
+        e->prev_used->next_used = e->next_used;
+    else
+        shard->first_used = e->next_used;
+    if (e->next_used != NULL)
+        e->next_used->prev_used = e->prev_used;
+    else
+        shard->last_used = e->prev_used;
+}
+
+static void
+link_first_used(shared_char_shard_t *shard, shared_char_entry_t *e)
+{
+    e->prev_used = NULL;
+    e->next_used = shard->first_used;
+    if (shard->first_used != NULL)
+        shard->first_used->prev_used = e;
+    else
+        shard->last_used = e;
+    shard->first_used = e;
+}
+
+static void
+remove_entry(gx_shared_char_cache_t *cache, shared_char_shard_t *shard,
+             shared_char_entry_t *e)
+{
+    shared_char_entry_t **pe = &shard->table[e->hash & shard->table_mask];
+
+    while (*pe != e)
+        pe = &(*pe)->next;
+    *pe = e->next;
+    unlink_used(shard, e);
+    shard->bytes -= e->size;
+    shard->count--;
+    gs_free_object(cache->memory, e, "shared_char_entry");
+}
+
+/* Discard the least recently used entries until we are within max. */
+static void
+trim_shard(gx_shared_char_cache_t *cache, shared_char_shard_t *shard, size_t max)
+{
+    while (shard->bytes > max && shard->last_used != NULL)
+        remove_entry(cache, shard, shard->last_used);
+}
+
+/* Double the hash table. If we can't, the chains just get longer. */
+static void
+grow_table(gx_shared_char_cache_t *cache, shared_char_shard_t *shard)
+{
+    uint size = (shard->table_mask + 1) * 2;
+    shared_char_entry_t **table = (shared_char_entry_t **)
+        gs_alloc_byte_array(cache->memory, size, sizeof(*table), "shared_char_shard(table)");
+    shared_char_entry_t *e;
+
+    if (table == NULL)
+        return;
+    memset(table, 0, size * sizeof(*table));
+    for (e = shard->first_used; e != NULL; e = e->next_used) {
+        e->next = table[e->hash & (size - 1)];
+        table[e->hash & (size - 1)] = e;
+    }
+    gs_free_object(cache->memory, shard->table, "shared_char_shard(table)");
+    shard->table = table;
+    shard->table_mask = size - 1;
+}
+
+static void
+shared_char_cache_free(gx_shared_char_cache_t *cache)
+{
+    gs_memory_t *mem = cache->memory;
+    int i;
+
+    for (i = 0; i < NUM_SHARDS; i++)
+        if (cache->shards[i].lock != NULL)
+            gx_monitor_free(cache->shards[i].lock);
+    /* This takes the entries, the tables and the cache itself with it. */
+    gs_malloc_memory_release((gs_malloc_memory_t *)mem);
+}
+
+static gx_shared_char_cache_t *
+shared_char_cache_alloc(void)
+{
+    gs_memory_t *mem = (gs_memory_t *)gs_malloc_memory_init();
+    gx_shared_char_cache_t *cache;
+    int i;
+
+    if (mem == NULL)
+        return NULL;
+    cache = (gx_shared_char_cache_t *)
+        gs_alloc_bytes(mem, sizeof(*cache), "shared_char_cache_alloc");
+    if (cache == NULL) {
+        gs_malloc_memory_release((gs_malloc_memory_t *)mem);
+        return NULL;
+    }
+    memset(cache, 0, sizeof(*cache));
+    cache->memory = mem;
+    for (i = 0; i < NUM_SHARDS; i++) {
+        shared_char_shard_t *shard = &cache->shards[i];
+
+        shard->lock = gx_monitor_label(gx_monitor_alloc(mem), "shared_char_shard");
+        shard->table = (shared_char_entry_t **)
+            gs_alloc_byte_array(mem, MIN_BUCKETS, sizeof(*shard->table),
+                                "shared_char_shard(table)");
+        if (shard->lock == NULL || shard->table == NULL) {
+            shared_char_cache_free(cache);
+            return NULL;
+        }
+        memset(shard->table, 0, MIN_BUCKETS * sizeof(*shard->table));
+        shard->table_mask = MIN_BUCKETS - 1;
+    }
+    return cache;
+}
+
+int
+gx_shared_char_cache_set_size(gs_memory_t *mem, size_t size)
+{
+    gs_lib_ctx_core_t *core = mem->gs_lib_ctx->core;
+    gs_globals *globals = core->globals;
+    gx_shared_char_cache_t *cache;
+    int i;
+
+    if (size == 0) {
+        gx_shared_char_cache_detach(mem);
+        return 0;
+    }
+    gp_global_lock(globals);
+    cache = (gx_shared_char_cache_t *)core->shared_char_cache;
+    if (cache == NULL) {
+        /* Without globals, each instance has a cache of its own. */
+        if (globals != NULL)
+            cache = (gx_shared_char_cache_t *)globals->char_cache;
+        if (cache == NULL) {
+            cache = shared_char_cache_alloc();
+            if (cache == NULL) {
+                gp_global_unlock(globals);
+                return_error(gs_error_VMerror);
+            }
+            if (globals != NULL)
+                globals->char_cache = cache;
+        }
+        cache->users++;
+        core->shared_char_cache = cache;
+    }
+    cache->size = size;
+    for (i = 0; i < NUM_SHARDS; i++) {
+        shared_char_shard_t *shard = &cache->shards[i];
+
+        gx_monitor_enter(shard->lock);
+        shard->max_bytes = size / NUM_SHARDS;
+        trim_shard(cache, shard, shard->max_bytes);
+        gx_monitor_leave(shard->lock);
+    }
+    gp_global_unlock(globals);
+    return 0;
+}
+
+size_t
+gx_shared_char_cache_size(const gs_memory_t *mem)
+{
+    gs_globals *globals;
+    size_t size;
+
+    if (!gx_shared_char_cache_active(mem))
+        return 0;
+    globals = mem->gs_lib_ctx->core->globals;
+    gp_global_lock(globals);
+    size = CACHE(mem)->size;
+    gp_global_unlock(globals);
+    return size;
+}
+
+void
+gx_shared_char_cache_detach(gs_memory_t *mem)
+{
+    gs_lib_ctx_core_t *core;
+    gx_shared_char_cache_t *cache;
+
+    if (!gx_shared_char_cache_active(mem))
+        return;
+    core = mem->gs_lib_ctx->core;
+    cache = (gx_shared_char_cache_t *)core->shared_char_cache;
+    gp_global_lock(core->globals);
+    core->shared_char_cache = NULL;
+    if (--cache->users == 0) {
+        if (core->globals != NULL && core->globals->char_cache == cache)
+            core->globals->char_cache = NULL;
+        shared_char_cache_free(cache);
+    }
+    gp_global_unlock(core->globals);
+}
+
+int
+gx_shared_char_cache_lookup(const gs_memory_t *mem,
+                            const byte *key, uint key_size,
+                            gx_shared_char_proc_t proc, void *arg)
+{
+    gx_shared_char_cache_t *cache;
+    shared_char_shard_t *shard;
+    shared_char_entry_t *e;
+    uint hash;
+    int code = 0;
+
+    if (!gx_shared_char_cache_active(mem))
+        return 0;
+    cache = CACHE(mem);
+    hash = hash_key(key, key_size);
+    shard = &cache->shards[SHARD_INDEX(hash)];
+    gx_monitor_enter(shard->lock);
+    e = find_entry(shard, hash, key, key_size);
+    if (e != NULL) {
+        unlink_used(shard, e);
+        link_first_used(shard, e);
+        code = proc(arg, ENTRY_VALUE(e), e->value_size);
+    }
+    gx_monitor_leave(shard->lock);
+    gx_stats_count(mem, e != NULL ? gx_stats_shared_char_cache_hit :
+                   gx_stats_shared_char_cache_miss);
+    return code;
+}
+
+void
+gx_shared_char_cache_add(const gs_memory_t *mem,
+                         const byte *key, uint key_size,
+                         const byte *head, uint head_size,
+                         const byte *data, uint data_size)
+{
+    gx_shared_char_cache_t *cache;
+    shared_char_shard_t *shard;
+    shared_char_entry_t *e;
+    size_t size = sizeof(*e) + key_size + head_size + data_size;
+    uint hash;
+
+    if (!gx_shared_char_cache_active(mem))
+        return;
+    cache = CACHE(mem);
+    hash = hash_key(key, key_size);
+    shard = &cache->shards[SHARD_INDEX(hash)];
+    gx_monitor_enter(shard->lock);
+    /* Another thread may have got there first. */
+    if (size > shard->max_bytes || find_entry(shard, hash, key, key_size) != NULL) {
+        gx_monitor_leave(shard->lock);
+        return;
+    }
+    trim_shard(cache, shard, shard->max_bytes - size);
+    e = (shared_char_entry_t *)gs_alloc_bytes(cache->memory, size, "shared_char_entry");
+    if (e != NULL) {
+        e->hash = hash;
+        e->key_size = key_size;
+        e->value_size = head_size + data_size;
+        e->size = size;
+        memcpy(ENTRY_KEY(e), key, key_size);
+        memcpy(ENTRY_VALUE(e), head, head_size);
+        if (data_size > 0)
+            memcpy(ENTRY_VALUE(e) + head_size, data, data_size);
+        e->next = shard->table[hash & shard->table_mask];
+        shard->table[hash & shard->table_mask] = e;
+        link_first_used(shard, e);
+        shard->bytes += size;
+        if (++shard->count > (shard->table_mask + 1) * 2)
+            grow_table(cache, shard);
+    }
+    gx_monitor_leave(shard->lock);
+}
@@ -0,0 +1,78 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  39 Mesa Street, Suite 108A, San Francisco,
+   CA 94129, USA, for further information.
+*/
+
+
+/* Process wide glyph bitmap cache (-dSharedGlyphCache=bytes) */
+
+#ifndef gxshchar_INCLUDED
+#  define gxshchar_INCLUDED
+
+#include "std.h"
+#include "gsmemory.h"
+#include "gslibctx.h"
+
+/*
+ * The character cache in a font directory (gxccman.c) belongs to one
+ * instance, so a process running several instances rasterises the same
+ * glyphs once per instance. The shared cache sits behind the per
+ * directory caches: characters whose font has a valid UniqueID or XUID
+ * are published to it once rendered, and a miss in the local cache
+ * looks here before rendering.
+ *
+ * The cache doesn't know what it holds; entries are opaque byte strings
+ * keyed on opaque byte strings (see gx_lookup_shared_char and
+ * gx_publish_shared_char in gxccman.c for what goes in them).
+ *
+ * There is one cache per process (held in the gs_globals), shared by all
+ * the instances that have attached to it. On platforms without globals
+ * each instance gets a cache of its own. The entries are spread over a
+ * number of independently locked shards, each with its own LRU list and
+ * a share of the memory budget, so that lookups from different threads
+ * rarely contend. The memory comes from a malloc allocator belonging to
+ * the cache itself, not to any of the instances.
+ */
+
+#define gx_shared_char_cache_active(mem)\
+  ((mem) != NULL && (mem)->gs_lib_ctx != NULL &&\
+   (mem)->gs_lib_ctx->core->shared_char_cache != NULL)
+
+/* Attach the instance to the cache (creating it if need be) and set
+ * the memory budget, in bytes. The budget is for the process, so the
+ * most recent setting by any instance wins. 0 detaches the instance. */
+int gx_shared_char_cache_set_size(gs_memory_t *mem, size_t size);
+
+/* Get the budget, or 0 if the instance isn't attached. */
+size_t gx_shared_char_cache_size(const gs_memory_t *mem);
+
+/* Detach the instance, freeing the cache if it was the last user. */
+void gx_shared_char_cache_detach(gs_memory_t *mem);
+
+/* Look up a key. If it is found, proc is called with the value while the
+ * entry is locked (so it must copy what it needs, and not call back into
+ * the cache), and we return what proc returns; otherwise we return 0. */
+typedef int (*gx_shared_char_proc_t)(void *arg, const byte *value, uint size);
+int gx_shared_char_cache_lookup(const gs_memory_t *mem,
+                                const byte *key, uint key_size,
+                                gx_shared_char_proc_t proc, void *arg);
+
+/* Add an entry whose value is head followed by data. If the key is
+ * already present, the existing entry is kept. Failing to add (for want
+ * of memory, or because the entry is too big) is not an error. */
+void gx_shared_char_cache_add(const gs_memory_t *mem,
+                              const byte *key, uint key_size,
+                              const byte *head, uint head_size,
+                              const byte *data, uint data_size);
+
+#endif /* gxshchar_INCLUDED */
@@ -0,0 +1,316 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  39 Mesa Street, Suite 108A, San Francisco,
+   CA 94129, USA, for further information.
+*/
+
+
+/* Run time timing and counters (-sEmitStats=file.json) */
+#include "memory_.h"
+#include "string_.h"
+#include "gx.h"
+#include "gserrors.h"
+#include "gsmalloc.h"
+#include "gp.h"
+#include "gxsync.h"
+#include "gxdevcli.h"
+#include "gxstats.h"
+
+typedef struct gx_stats_band_s {
+    int band;
+    gx_stats_clock time;
+} gx_stats_band_t;
+
+typedef struct gx_stats_s {
+    gs_memory_t *memory;        /* our own malloc allocator */
+    gx_monitor_t *lock;         /* updates can come from rendering threads */
+    gp_file *file;
+    char *fname;
+    int pages;
+    gx_stats_clock page_end;    /* end of the last page (or when we started) */
+    long count[gx_stats_num_timers];
+    gx_stats_clock time[gx_stats_num_timers];
+    long counter[gx_stats_num_counters];
+    /* The values at the end of the last page, for the per page figures. */
+    long page_count[gx_stats_num_timers];
+    gx_stats_clock page_time[gx_stats_num_timers];
+    long page_counter[gx_stats_num_counters];
+    /* The bands rendered since the last page. */
+    gx_stats_band_t *bands;
+    int num_bands;
+    int max_bands;
+} gx_stats_t;
+
+static const char *const timer_names[gx_stats_num_timers] = {
+    "fill_path", "stroke_path", "fill_stroke_path", "image", "text",
+    "glyph", "pdf14_compose", "icc_link", "clist_write", "band_render",
+    "print_page"
+};
+
+/* The counters come in hit/miss pairs. */
+static const char *const cache_names[gx_stats_num_counters / 2] = {
+    "char", "pattern", "icc_link", "object", "image", "shared_char",
+    "pattern_kept"
+};
+
+#define STATS(mem) ((gx_stats_t *)(mem)->gs_lib_ctx->core->stats)
+
+gx_stats_clock
+gx_stats_now(void)
+{
+    long t[2];
+
+    gp_get_realtime(t);
+    return (gx_stats_clock)t[0] * 1000000000 + t[1];
+}
+
+void
+gx_stats_add_time(const gs_memory_t *mem, gx_stats_timer_t which, gx_stats_clock start)
+{
+    gx_stats_t *stats;
+    gx_stats_clock now = gx_stats_now();
+
+    if (!gx_stats_active(mem))
+        return;
+    stats = STATS(mem);
+    gx_monitor_enter(stats->lock);
+    stats->count[which]++;
+    stats->time[which] += now - start;
+    gx_monitor_leave(stats->lock);
+}
+
+void
+gx_stats_add_count(const gs_memory_t *mem, gx_stats_counter_t which)
+{
+    gx_stats_t *stats;
+
+    if (!gx_stats_active(mem))
+        return;
+    stats = STATS(mem);
+    gx_monitor_enter(stats->lock);
+    stats->counter[which]++;
+    gx_monitor_leave(stats->lock);
+}
+
+void
+gx_stats_band(const gs_memory_t *mem, int band, gx_stats_clock start)
+{
+    gx_stats_t *stats;
+    gx_stats_clock now = gx_stats_now();
+
+    if (start == 0 || !gx_stats_active(mem))
+        return;
+    stats = STATS(mem);
+    gx_monitor_enter(stats->lock);
+    stats->count[gx_stats_band_render]++;
+    stats->time[gx_stats_band_render] += now - start;
+    if (stats->num_bands == stats->max_bands) {
+        int max = stats->max_bands == 0 ? 64 : stats->max_bands * 2;
+        gx_stats_band_t *bands = (gx_stats_band_t *)
+            gs_alloc_bytes(stats->memory, max * sizeof(*bands), "gx_stats_band");
+
+        /* If we can't grow the list, the band still counts towards the totals. */
+        if (bands != NULL) {
+            if (stats->num_bands > 0)
+                memcpy(bands, stats->bands, stats->num_bands * sizeof(*bands));
+            gs_free_object(stats->memory, stats->bands, "gx_stats_band");
+            stats->bands = bands;
+            stats->max_bands = max;
+        }
+    }
+    if (stats->num_bands < stats->max_bands) {
+        stats->bands[stats->num_bands].band = band;
+        stats->bands[stats->num_bands].time = now - start;
+        stats->num_bands++;
+    }
+    gx_monitor_leave(stats->lock);
+}
+
+static double
+ms(gx_stats_clock t)
+{
+    return (double)t / 1000000.0;
+}
+
+/* Write the timers and counters, less the given base values (if any). */
+static void
+write_figures(gx_stats_t *stats, const char *indent, const long *base_count,
+              const gx_stats_clock *base_time, const long *base_counter)
+{
+    gp_file *f = stats->file;
+    int i, first = 1;
+
+    gp_fprintf(f, "%s\"ops\": {", indent);
+    for (i = 0; i < gx_stats_num_timers; i++) {
+        long count = stats->count[i] - (base_count ? base_count[i] : 0);
+        gx_stats_clock time = stats->time[i] - (base_time ? base_time[i] : 0);
+
+        if (count == 0)
+            continue;
+        gp_fprintf(f, "%s\n%s  \"%s\": { \"count\": %ld, \"ms\": %.3f }",
+                   first ? "" : ",", indent, timer_names[i], count, ms(time));
+        first = 0;
+    }
+    gp_fprintf(f, "%s},\n", first ? "" : "\n");
+    gp_fprintf(f, "%s\"caches\": {", indent);
+    for (i = 0, first = 1; i < gx_stats_num_counters; i += 2) {
+        long hits = stats->counter[i] - (base_counter ? base_counter[i] : 0);
+        long misses = stats->counter[i + 1] - (base_counter ? base_counter[i + 1] : 0);
+
+        if (hits + misses == 0)
+            continue;
+        gp_fprintf(f, "%s\n%s  \"%s\": { \"hits\": %ld, \"misses\": %ld, \"hit_rate\": %.4f }",
+                   first ? "" : ",", indent, cache_names[i / 2], hits, misses,
+                   (double)hits / (hits + misses));
+        first = 0;
+    }
+    gp_fprintf(f, "%s}", first ? "" : "\n");
+}
+
+void
+gx_stats_page(gx_device *dev, gx_stats_clock start)
+{
+    gs_memory_t *mem = dev->memory;
+    gx_stats_t *stats;
+    gx_stats_clock now = gx_stats_now();
+    int i;
+
+    if (start == 0 || !gx_stats_active(mem))
+        return;
+    /* Report the real device, not any subclass sitting on top of it. */
+    while (dev->child != NULL)
+        dev = dev->child;
+    stats = STATS(mem);
+    gx_monitor_enter(stats->lock);
+    stats->pages++;
+    if (stats->file != NULL) {
+        gp_file *f = stats->file;
+
+        gp_fprintf(f, "%s\n    {\n      \"page\": %d,\n      \"device\": \"%s\",\n",
+                   stats->pages == 1 ? "" : ",", stats->pages, dev->dname);
+        gp_fprintf(f, "      \"width\": %d,\n      \"height\": %d,\n",
+                   dev->width, dev->height);
+        gp_fprintf(f, "      \"interpret_ms\": %.3f,\n      \"output_page_ms\": %.3f,\n",
+                   ms(start - stats->page_end), ms(now - start));
+        write_figures(stats, "      ", stats->page_count, stats->page_time, stats->page_counter);
+        gp_fprintf(f, ",\n      \"bands\": [");
+        for (i = 0; i < stats->num_bands; i++)
+            gp_fprintf(f, "%s{ \"band\": %d, \"ms\": %.3f }", i == 0 ? "" : ", ",
+                       stats->bands[i].band, ms(stats->bands[i].time));
+        gp_fprintf(f, "]\n    }");
+        gp_fflush(f);
+    }
+    memcpy(stats->page_count, stats->count, sizeof(stats->count));
+    memcpy(stats->page_time, stats->time, sizeof(stats->time));
+    memcpy(stats->page_counter, stats->counter, sizeof(stats->counter));
+    stats->num_bands = 0;
+    stats->page_end = gx_stats_now();
+    gx_monitor_leave(stats->lock);
+}
+
+static void
+stats_free(gx_stats_t *stats)
+{
+    gs_memory_t *mem = stats->memory;
+
+    if (stats->lock != NULL)
+        gx_monitor_free(stats->lock);
+    /* This takes the name, the bands and the stats themselves with it. */
+    gs_malloc_memory_release((gs_malloc_memory_t *)mem);
+}
+
+/*
+ * The collector belongs to the instance as a whole, but the parameter
+ * that starts it arrives through a device, whose memory (in gpdl, that
+ * of one of the interpreters) may go long before the instance does. So
+ * we have an allocator of our own, as the shared glyph cache does.
+ */
+int
+gx_stats_open(gs_memory_t *mem, const char *fname, uint len)
+{
+    gs_lib_ctx_core_t *core = mem->gs_lib_ctx->core;
+    gx_stats_t *stats = (gx_stats_t *)core->stats;
+    gs_memory_t *smem;
+    gp_file *f;
+
+    if (stats != NULL && strlen(stats->fname) == len && !memcmp(stats->fname, fname, len))
+        return 0;
+
+    smem = (gs_memory_t *)gs_malloc_memory_init();
+    if (smem == NULL)
+        return_error(gs_error_VMerror);
+    /* gp_fopen needs the file system list and the file controls. */
+    smem->gs_lib_ctx = mem->gs_lib_ctx;
+    stats = (gx_stats_t *)gs_alloc_bytes(smem, sizeof(*stats), "gx_stats_open");
+    if (stats == NULL) {
+        gs_malloc_memory_release((gs_malloc_memory_t *)smem);
+        return_error(gs_error_VMerror);
+    }
+    memset(stats, 0, sizeof(*stats));
+    stats->memory = smem;
+    stats->fname = (char *)gs_alloc_bytes(smem, len + 1, "gx_stats_open(fname)");
+    stats->lock = gx_monitor_label(gx_monitor_alloc(smem), "gx_stats");
+    if (stats->fname == NULL || stats->lock == NULL) {
+        stats_free(stats);
+        return_error(gs_error_VMerror);
+    }
+    memcpy(stats->fname, fname, len);
+    stats->fname[len] = 0;
+    if (gp_validate_path(mem, stats->fname, "w") != 0)
+        f = NULL;
+    else
+        f = gp_fopen(smem, stats->fname, "w");
+    if (f == NULL) {
+        stats_free(stats);
+        return_error(gs_error_invalidfileaccess);
+    }
+
+    /* Changing the file finishes the old one. */
+    gx_stats_close(mem);
+
+    stats->file = f;
+    stats->page_end = gx_stats_now();
+    gp_fprintf(f, "{\n  \"pages\": [");
+    core->stats = stats;
+    return 0;
+}
+
+const char *
+gx_stats_file_name(const gs_memory_t *mem)
+{
+    if (!gx_stats_active(mem))
+        return NULL;
+    return STATS(mem)->fname;
+}
+
+void
+gx_stats_close(gs_memory_t *mem)
+{
+    gs_lib_ctx_core_t *core;
+    gx_stats_t *stats;
+
+    if (!gx_stats_active(mem))
+        return;
+    core = mem->gs_lib_ctx->core;
+    stats = (gx_stats_t *)core->stats;
+    /* Stop collecting before we tear things down. */
+    core->stats = NULL;
+
+    if (stats->file != NULL) {
+        gp_fprintf(stats->file, "%s],\n  \"totals\": {\n    \"pages\": %d,\n",
+                   stats->pages == 0 ? "" : "\n  ", stats->pages);
+        write_figures(stats, "    ", NULL, NULL, NULL);
+        gp_fprintf(stats->file, "\n  }\n}\n");
+        gp_fclose(stats->file);
+    }
+    stats_free(stats);
+}
@@ -0,0 +1,113 @@
+/* Copyright (C) 2001-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  39 Mesa Street, Suite 108A, San Francisco,
+   CA 94129, USA, for further information.
+*/
+
+
+/* Run time timing and counters (-sEmitStats=file.json) */
+
+#ifndef gxstats_INCLUDED
+#  define gxstats_INCLUDED
+
+#include "stdint_.h"
+#include "gsmemory.h"
+#include "gslibctx.h"
+#include "gsdevice.h"
+
+/*
+ * When a device is given an EmitStats file name, we start collecting
+ * timings and counters for the whole instance (including any rendering
+ * threads), and write them out as JSON: one record per page, followed
+ * by the totals when the instance shuts down.
+ *
+ * The hooks are arranged so that they cost a single pointer test when
+ * stats are not being collected:
+ *
+ *      gx_stats_clock t;
+ *
+ *      gx_stats_begin(mem, t);
+ *      code = ...the work...;
+ *      gx_stats_end(mem, gx_stats_fill_path, t);
+ *
+ * Timings are wall clock and inclusive, so (for instance) a fill_path
+ * done while rendering a glyph counts towards both.
+ */
+
+typedef enum {
+    gx_stats_fill_path,         /* gx_fill_path */
+    gx_stats_stroke_path,       /* gx_stroke_fill */
+    gx_stats_fill_stroke_path,  /* gx_fill_stroke_path */
+    gx_stats_image,             /* gx_image_plane_data_rows */
+    gx_stats_text,              /* gs_text_process */
+    gx_stats_glyph,             /* rendering a glyph through FAPI */
+    gx_stats_pdf14_compose,     /* popping a transparency group */
+    gx_stats_icc_link,          /* building an ICC link */
+    gx_stats_clist_write,       /* cmd_write_buffer, flushing band commands */
+    gx_stats_band_render,       /* clist playback of a band */
+    gx_stats_print_page,        /* print_page, including output encoding */
+    gx_stats_num_timers
+} gx_stats_timer_t;
+
+typedef enum {
+    gx_stats_char_cache_hit,
+    gx_stats_char_cache_miss,
+    gx_stats_pattern_cache_hit,
+    gx_stats_pattern_cache_miss,
+    gx_stats_icc_cache_hit,
+    gx_stats_icc_cache_miss,
+    gx_stats_object_cache_hit,
+    gx_stats_object_cache_miss,
+    gx_stats_image_cache_hit,
+    gx_stats_image_cache_miss,
+    gx_stats_shared_char_cache_hit,
+    gx_stats_shared_char_cache_miss,
+    gx_stats_pattern_kept_hit,
+    gx_stats_pattern_kept_miss,
+    gx_stats_num_counters
+} gx_stats_counter_t;
+
+/* Times are in nanoseconds; 0 means "not timing". */
+typedef int64_t gx_stats_clock;
+
+#define gx_stats_active(mem)\
+  ((mem) != NULL && (mem)->gs_lib_ctx != NULL &&\
+   (mem)->gs_lib_ctx->core->stats != NULL)
+
+#define gx_stats_begin(mem, t)\
+  ((t) = (gx_stats_active(mem) ? gx_stats_now() : 0))
+#define gx_stats_end(mem, which, t)\
+  do { if ((t) != 0) gx_stats_add_time(mem, which, t); } while (0)
+#define gx_stats_count(mem, which)\
+  do { if (gx_stats_active(mem)) gx_stats_add_count(mem, which); } while (0)
+
+gx_stats_clock gx_stats_now(void);
+void gx_stats_add_time(const gs_memory_t *mem, gx_stats_timer_t which, gx_stats_clock start);
+void gx_stats_add_count(const gs_memory_t *mem, gx_stats_counter_t which);
+
+/* Record the rendering of band (which also counts as gx_stats_band_render). */
+void gx_stats_band(const gs_memory_t *mem, int band, gx_stats_clock start);
+
+/* Write the record for a page; start is when output_page was called. */
+void gx_stats_page(gx_device *dev, gx_stats_clock start);
+
+/* Start collecting, writing to the named file. Setting the same name
+ * again does nothing. */
+int gx_stats_open(gs_memory_t *mem, const char *fname, uint len);
+
+/* Get the current file name, if any. */
+const char *gx_stats_file_name(const gs_memory_t *mem);
+
+/* Write the totals and stop collecting. */
+void gx_stats_close(gs_memory_t *mem);
+
+#endif /* gxstats_INCLUDED */
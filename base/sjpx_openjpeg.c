@@ -64,7 +64,12 @@ static int opj_lock(gs_memory_t *mem)
 
     ret = gx_monitor_enter((gx_monitor_t *)ctx->sjpxd_private);
     assert(opj_memory == NULL);
-    opj_memory = mem->non_gc_memory;
+    /* If openjpeg was built with thread support it may allocate from its own
+     * threads while we hold the lock, so it needs a thread safe allocator. */
+    if (opj_has_thread_support() && mem->thread_safe_memory != NULL)
+        opj_memory = mem->thread_safe_memory;
+    else
+        opj_memory = mem->non_gc_memory;
     return ret;
 #else
     return 0;
@@ -297,6 +302,13 @@ s_opjd_set_codec_format(stream_state * ss, OPJ_CODEC_FORMAT format)
         return ERRC;
     }
 
+#if OPJ_VERSION_MAJOR > 2 || (OPJ_VERSION_MAJOR == 2 && OPJ_VERSION_MINOR >= 2)
+    /* Always set this, so that OPJ_NUM_THREADS in the environment doesn't
+     * start threads we didn't ask for. Without thread support in openjpeg
+     * this fails, and we decode on this thread as before. */
+    (void)opj_codec_set_threads(state->codec, state->threads > 1 ? state->threads : 0);
+#endif
+
     /* open a byte stream */
     state->stream = opj_stream_default_create(OPJ_TRUE);
     if (state->stream == NULL)
@@ -385,9 +397,87 @@ ycc_to_rgb_16(unsigned char *row, unsigned long row_size)
     while (row_size);
 }
 
+static int decode_image(stream_jpxd_state * const state);
+
+/* Free the codec and the stream (but not the image), with the lock held */
+static void
+s_opjd_destroy_codec(stream_jpxd_state * const state)
+{
+    if (state->stream)
+        opj_stream_destroy(state->stream);
+    state->stream = NULL;
+    if (state->codec)
+        opj_destroy_codec(state->codec);
+    state->codec = NULL;
+}
+
+/* The start of the data tells us whether it is a raw codestream or a JP2 file */
+static OPJ_CODEC_FORMAT
+s_opjd_codec_format(stream_jpxd_state * const state)
+{
+    /* state->sb.size is non-zero after successful
+       accumulate_input(); 1 is probably extremely rare */
+    if (state->sb.data[0] == 0xFF && ((state->sb.size == 1) || (state->sb.data[1] == 0x4F)))
+        return OPJ_CODEC_J2K;
+    return OPJ_CODEC_JP2;
+}
+
+static void
+s_opjd_set_stream_data(stream_jpxd_state * const state)
+{
+#if OPJ_VERSION_MAJOR >= 2 && OPJ_VERSION_MINOR >= 1
+    opj_stream_set_user_data(state->stream, &(state->sb), NULL);
+#else
+    opj_stream_set_user_data(state->stream, &(state->sb));
+#endif
+    opj_stream_set_user_data_length(state->stream, state->sb.size);
+}
+
+/* Decoding at a reduced resolution failed, which can happen if a tile has fewer
+ * resolution levels than the main header says, so start again at full resolution.
+ */
+static int restart_decode(stream_jpxd_state * const state)
+{
+    int code;
+
+    opj_image_destroy(state->image);
+    state->image = NULL;
+    s_opjd_destroy_codec(state);
+    state->sb.pos = 0;
+    state->reduce = 0;
+
+    code = s_opjd_set_codec_format((stream_state *)state, s_opjd_codec_format(state));
+    if (code < 0)
+        return code;
+    s_opjd_set_stream_data(state);
+    return decode_image(state);
+}
+
+/* Limit the number of resolution levels to leave out to what every component
+ * has (according to the main header), returning the number we can use.
+ */
+static int limit_reduce(stream_jpxd_state * const state)
+{
+    opj_codestream_info_v2_t *info;
+    int reduce = state->reduce, compno;
+
+    info = opj_get_cstr_info(state->codec);
+    if (info == NULL || info->m_default_tile_info.tccp_info == NULL)
+        reduce = 0;
+    else {
+        for (compno = 0; compno < info->nbcomps; compno++)
+            if (reduce >= (int)info->m_default_tile_info.tccp_info[compno].numresolutions)
+                reduce = (int)info->m_default_tile_info.tccp_info[compno].numresolutions - 1;
+    }
+    if (info != NULL)
+        opj_destroy_cstr_info(&info);
+    return reduce < 0 ? 0 : reduce;
+}
+
 static int decode_image(stream_jpxd_state * const state)
 {
     int numprimcomp = 0, alpha_comp = -1, compno, rowbytes;
+    int reduce = 0;
 
     /* read header */
     if (!opj_read_header(state->stream, state->codec, &(state->image)))
@@ -396,14 +486,7 @@ static int decode_image(stream_jpxd_state * const state)
     	return ERRC;
     }
 
-    /* decode the stream and fill the image structure */
-    if (!opj_decode(state->codec, state->stream, state->image))
-    {
-        dlprintf("openjpeg: failed to decode image!\n");
-        return ERRC;
-    }
-
-    /* check dimension and prec */
+    /* check dimension and prec, the output is always the full size */
     if (state->image->numcomps == 0)
         return ERRC;
 
@@ -424,6 +507,25 @@ static int decode_image(stream_jpxd_state * const state)
             state->samescale = false;
     }
 
+    /* process_one_trunk() can only replicate samples of 8 bits or more */
+    if (state->reduce > 0 && state->bpp >= 8)
+        reduce = limit_reduce(state);
+    if (reduce > 0) {
+        if (opj_set_decoded_resolution_factor(state->codec, reduce))
+            state->samescale = false; /* process_one_trunk has to replicate samples */
+        else
+            reduce = 0;
+    }
+
+    /* decode the stream and fill the image structure */
+    if (!opj_decode(state->codec, state->stream, state->image))
+    {
+        if (reduce > 0)
+            return restart_decode(state);
+        dlprintf("openjpeg: failed to decode image!\n");
+        return ERRC;
+    }
+
     /* find alpha component and regular colour component by channel definition */
     for (compno = 0; compno < state->image->numcomps; compno++)
     {
@@ -514,6 +616,21 @@ static int decode_image(stream_jpxd_state * const state)
     return 0;
 }
 
+/* The offset in a component's data of the sample for the output pixel x, y,
+ * allowing for subsampled components and decoding at a reduced resolution.
+ */
+static inline int comp_offset(const opj_image_comp_t *comp, int x, int y)
+{
+    unsigned int cx = ((unsigned int)x / comp->dx) >> comp->factor;
+    unsigned int cy = ((unsigned int)y / comp->dy) >> comp->factor;
+
+    if (cx >= comp->w)
+        cx = comp->w - 1;
+    if (cy >= comp->h)
+        cy = comp->h - 1;
+    return cy * comp->w + cx;
+}
+
 static int process_one_trunk(stream_jpxd_state * const state, stream_cursor_write * pw)
 {
     /* read data from image to pw */
@@ -621,10 +738,7 @@ static int process_one_trunk(stream_jpxd_state * const state, stream_cursor_writ
                 {
                     for (i = 0; i < state->width; i++)
                     {
-                        int dx = state->image->comps[state->alpha_comp].dx;
-                        int dy = state->image->comps[state->alpha_comp].dy;
-                        int w = state->image->comps[state->alpha_comp].w;
-                        int in_offset_scaled = (y_offset/dy * w) + i / dx;
+                        int in_offset_scaled = comp_offset(&state->image->comps[state->alpha_comp], i, y_offset);
                         for (b=0; b<bytepp1; b++)
                             *row++ = (((state->image->comps[state->alpha_comp].data[in_offset_scaled] << shift_bit) >> (8*(bytepp1-b-1))))
                                                                      + (b==0 ? state->sign_comps[state->alpha_comp] : 0);
@@ -636,10 +750,7 @@ static int process_one_trunk(stream_jpxd_state * const state, stream_cursor_writ
                     {
                         for (compno=0; compno<img_numcomps; compno++)
                         {
-                            int dx = state->image->comps[compno].dx;
-                            int dy = state->image->comps[compno].dy;
-                            int w = state->image->comps[compno].w;
-                            int in_offset_scaled = (y_offset/dy * w) + i / dx;
+                            int in_offset_scaled = comp_offset(&state->image->comps[compno], i, y_offset);
                             for (b=0; b<bytepp1; b++)
                                 *row++ = (((state->image->comps[compno].data[in_offset_scaled] << shift_bit) >> (8*(bytepp1-b-1))))
                                                                                 + (b==0 ? state->sign_comps[compno] : 0);
@@ -658,10 +769,7 @@ static int process_one_trunk(stream_jpxd_state * const state, stream_cursor_writ
                 {
                     for (b=0; b<ppbyte1; b++)
                     {
-                        int dx = state->image->comps[compno].dx;
-                        int dy = state->image->comps[compno].dy;
-                        int w = state->image->comps[compno].w;
-                        int in_offset_scaled = (y_offset/dy * w) + i / dx;
+                        int in_offset_scaled = comp_offset(&state->image->comps[compno], i, y_offset);
                         bt = bt<<state->bpp;
                         bt += state->image->comps[compno].data[in_offset_scaled] + state->sign_comps[compno];
                     }
@@ -730,12 +838,7 @@ s_opjd_process(stream_state * ss, stream_cursor_read * pr,
         }
 
         if (state->codec == NULL) {
-            /* state->sb.size is non-zero after successful
-               accumulate_input(); 1 is probably extremely rare */
-            if (state->sb.data[0] == 0xFF && ((state->sb.size == 1) || (state->sb.data[1] == 0x4F)))
-                code = s_opjd_set_codec_format(ss, OPJ_CODEC_J2K);
-            else
-                code = s_opjd_set_codec_format(ss, OPJ_CODEC_JP2);
+            code = s_opjd_set_codec_format(ss, s_opjd_codec_format(state));
             if (code < 0)
             {
                 (void)opj_unlock(ss->memory);
@@ -757,13 +860,19 @@ s_opjd_process(stream_state * ss, stream_cursor_read * pr,
                 locked = 1;
             }
 
-#if OPJ_VERSION_MAJOR >= 2 && OPJ_VERSION_MINOR >= 1
-            opj_stream_set_user_data(state->stream, &(state->sb), NULL);
-#else
-            opj_stream_set_user_data(state->stream, &(state->sb));
-#endif
-            opj_stream_set_user_data_length(state->stream, state->sb.size);
+            /* no data, or we already tried to decode it and failed */
+            if (state->codec == NULL)
+            {
+                (void)opj_unlock(ss->memory);
+                return ERRC;
+            }
+
+            s_opjd_set_stream_data(state);
             ret = decode_image(state);
+            /* We only need the image now. If openjpeg is using threads they can
+             * still allocate after opj_decode() returns, until the codec (and its
+             * thread pool) is destroyed, so do that while we hold the lock. */
+            s_opjd_destroy_codec(state);
             if (ret != 0)
             {
                 (void)opj_unlock(ss->memory);
@@ -796,6 +905,8 @@ s_opjd_set_defaults(stream_state * ss) {
 
     state->alpha = false;
     state->colorspace = gs_jpx_cs_rgb;
+    state->threads = 0;
+    state->reduce = 0;
     state->StartedPassThrough = 0;
     state->PassThrough = 0;
     state->PassThroughfn = NULL;
@@ -814,25 +925,21 @@ s_opjd_release(stream_state *ss)
         state->StartedPassThrough = 0;
         (state->PassThroughfn)(state->device, NULL, 0);
     }
-    /* empty stream or failed to accumulate */
-    if (state->codec == NULL)
-        return;
+    /* the codec is freed once the image is decoded, so there is only
+       anything here to free if we got that far */
+    if (state->codec != NULL || state->image != NULL) {
+        (void)opj_lock(ss->memory);
 
-    (void)opj_lock(ss->memory);
+        /* free image data structure */
+        if (state->image)
+            opj_image_destroy(state->image);
+        state->image = NULL;
 
-    /* free image data structure */
-    if (state->image)
-        opj_image_destroy(state->image);
+        /* free stream and decoder handle */
+        s_opjd_destroy_codec(state);
 
-    /* free stream */
-    if (state->stream)
-        opj_stream_destroy(state->stream);
-
-    /* free decoder handle */
-    if (state->codec)
-	opj_destroy_codec(state->codec);
-
-    (void)opj_unlock(ss->memory);
+        (void)opj_unlock(ss->memory);
+    }
 
     /* free input buffer */
     if (state->sb.data)
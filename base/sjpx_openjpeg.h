@@ -59,6 +59,9 @@ typedef struct stream_jpxd_state_s
 
     gs_jpx_cs colorspace;	/* requested output colorspace */
     bool alpha; /* return opacity channel */
+    int threads; /* threads for openjpeg to decode with, 0 or 1 for none */
+    int reduce; /* leave out this many resolution levels (each halves the width and
+                   height), the output is still full size, with the samples replicated */
 
     stream_block sb;
 
@@ -98,18 +98,23 @@ lzw_reset_encode(stream_LZW_state *ss)
 #define ss ((stream_LZW_state *)st)
 
 /* Initialize LZWEncode filter */
+/* We separate out the reset function for some non-stream clients. */
 static int
-s_LZWE_init(stream_state *st)
+s_LZWE_reset(stream_state *st)
 {	ss->bits_left = 8;
         ss->bits = 0; /* for Purify, the value unimportant due to ss->bits_left == 8 */
-        ss->table.encode = gs_alloc_struct(st->memory,
-                        lzw_encode_table, &st_lzwe_table, "LZWEncode init");
-        if ( ss->table.encode == 0 )
-                return ERRC;		/****** WRONG ******/
         ss->first = true;
         lzw_reset_encode(ss);
         return 0;
 }
+static int
+s_LZWE_init(stream_state *st)
+{	ss->table.encode = gs_alloc_struct(st->memory,
+                        lzw_encode_table, &st_lzwe_table, "LZWEncode init");
+        if ( ss->table.encode == 0 )
+                return ERRC;		/****** WRONG ******/
+        return s_LZWE_reset(st);
+}
 
 /* Process a buffer */
 static int
@@ -204,5 +209,5 @@ out:	ss->prev_code = code;
 /* Stream template */
 const stream_template s_LZWE_template =
 {	&st_LZW_state, s_LZWE_init, s_LZWE_process, 1, 4, s_LZW_release,
-        s_LZW_set_defaults
+        s_LZW_set_defaults, s_LZWE_reset
 };
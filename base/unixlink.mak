@@ -280,6 +280,25 @@ $(GPDL_XE): $(ld_tr) $(gpdl_tr) $(INT_ARCHIVE_ALL) $(REALMAIN_OBJ) $(MAIN_OBJ) \
 	$(NO_OP)
 
 
+# Bit exactness check and timings for the SIMD row compositors, see
+# base/blendbench.c.
+BLENDBENCH_XE=$(BINDIR)$(D)blendbench$(XE)
+
+blendbench: $(BLENDBENCH_XE)
+	$(BLENDBENCH_XE)
+
+$(BLENDBENCH_XE): $(GLOBJ)blendbench.$(OBJ) $(GLOBJ)gxblendrow.$(OBJ) $(UNIXLINK_MAK) $(MAKEDIRS)
+	$(CCLD) $(LDFLAGS) -o $(BLENDBENCH_XE) $(GLOBJ)blendbench.$(OBJ) $(GLOBJ)gxblendrow.$(OBJ) $(STDLIBS)
+
+# The same for the SIMD downscaler box filters, see base/downbench.c.
+DOWNBENCH_XE=$(BINDIR)$(D)downbench$(XE)
+
+downbench: $(DOWNBENCH_XE)
+	$(DOWNBENCH_XE)
+
+$(DOWNBENCH_XE): $(GLOBJ)downbench.$(OBJ) $(GLOBJ)gxdownbox.$(OBJ) $(UNIXLINK_MAK) $(MAKEDIRS)
+	$(CCLD) $(LDFLAGS) -o $(DOWNBENCH_XE) $(GLOBJ)downbench.$(OBJ) $(GLOBJ)gxdownbox.$(OBJ) $(STDLIBS)
+
 APITEST_XE=$(BINDIR)$(D)apitest$(XE)
 
 apitest: $(APITEST_XE)
@@ -0,0 +1,355 @@
+/* Copyright (C) 2018-2023 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  39 Mesa Street, Suite 108A, San Francisco,
+   CA 94129, USA, for further information.
+*/
+
+/* Example file to demonstrate page parallel rendering of a single
+ * PDF file using multiple instances of the ghostscript/GPDL library.
+ *
+ * The PDF interpreter runs a single page at a time, and only the
+ * rasterisation of each page (NumRenderingThreads) is threaded. For
+ * long, interpreter bound, documents we can do better by running
+ * several instances at once, each interpreting a disjoint set of
+ * pages. Random access through the xref means that each instance
+ * only has to parse the pages it has been given.
+ *
+ * Worker n (of N) renders pages n+1, n+1+N, n+1+2N... by way of
+ * -sPageList. Each worker writes to its own temporary files, and
+ * once all the workers have finished, these are renamed into place
+ * so that the output files are numbered in document page order.
+ *
+ * Usage:
+ *
+ *   page_parallel <N> <input.pdf> <output template> [gs args...]
+ *
+ * where the output template must contain a single %d (e.g.
+ * out%04d.png) and any extra arguments (-sDEVICE=, -r etc) are
+ * passed to every instance.
+ */
+
+#ifdef _WIN32
+/* Stop windows builds complaining about sprintf being insecure. */
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#define WINDOWS
+#else
+#include <pthread.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory.h>
+#include <assert.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+/* This can work either with the Ghostscript or GhostPDL
+ * library. The code is the same for both. */
+#if GHOSTPDL
+#include "pcl/pl/plapi.h"   /* GSAPI - gpdf version */
+#else
+#include "psi/iapi.h"       /* GSAPI - ghostscript version */
+#endif
+
+#define MAX_WORKERS (64)
+#define MAX_ARGS (64)
+
+/* We hold details of each threads working in a thread_data
+ * structure. */
+typedef struct
+{
+    /* What worker number are we ? */
+    int thread_num;
+    /* How many workers are there in total ? */
+    int num_workers;
+    /* How many pages in the document ? */
+    int num_pages;
+    /* What input file should this worker use? */
+    char *in_file;
+    /* The output file template (with a %d in it) */
+    char *out_template;
+    /* Extra arguments to pass to each instance */
+    int extra_argc;
+    char **extra_argv;
+    /* Somewhere to store the thread id */
+#ifdef WINDOWS
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+    /* exit code for the thread */
+    int code;
+} thread_data;
+
+/* The temporary output file template for a given worker. */
+static void
+worker_template(char *buf, size_t len, const char *out_template, int thread_num)
+{
+    snprintf(buf, len, "%s.w%d", out_template, thread_num);
+}
+
+/* The function to perform the work of the thread.
+ * Starts a gs instance, runs its share of the pages, shuts it down.
+ */
+static
+#ifdef WINDOWS
+DWORD WINAPI
+#else
+void *
+#endif
+worker(void *td_)
+{
+    thread_data *td = (thread_data *)td_;
+    int code;
+    void *instance  = NULL;
+    char out[1024];
+    char *pagelist = NULL;
+    size_t pagelist_len;
+    int page, i, len;
+
+    /* Construct the argc/argv to pass to ghostscript. */
+    int argc = 0;
+    char *argv[MAX_ARGS];
+
+    /* Pages thread_num+1, thread_num+1+num_workers, ... Allow
+     * enough room for each page number, a comma and the prefix. */
+    pagelist_len = 16 + (td->num_pages / td->num_workers + 1) * 12;
+    pagelist = malloc(pagelist_len);
+    if (pagelist == NULL) {
+        code = -1;
+        goto failearly;
+    }
+    len = sprintf(pagelist, "-sPageList=");
+    for (page = td->thread_num + 1; page <= td->num_pages; page += td->num_workers)
+        len += sprintf(pagelist + len, "%s%d", page == td->thread_num + 1 ? "" : ",", page);
+
+    worker_template(out, sizeof(out), td->out_template, td->thread_num);
+    argv[argc++] = "gpdl";
+    argv[argc++] = "-q";
+    argv[argc++] = pagelist;
+    argv[argc++] = "-o";
+    argv[argc++] = out;
+    for (i = 0; i < td->extra_argc && argc < MAX_ARGS - 1; i++)
+        argv[argc++] = td->extra_argv[i];
+    argv[argc++] = td->in_file;
+
+    /* Create a GS instance. */
+    code = gsapi_new_instance(&instance, NULL);
+    if (code < 0) {
+        printf("Error %d in gsapi_new_instance\n", code);
+        goto failearly;
+    }
+
+    /* Run our pages. */
+    code = gsapi_init_with_args(instance, argc, argv);
+    if (code < 0) {
+        printf("Error %d in gsapi_init_with_args\n", code);
+        goto fail;
+    }
+
+    /* Close the interpreter down (important, or we will leak!) */
+    code = gsapi_exit(instance);
+    if (code < 0) {
+        printf("Error %d in gsapi_exit\n", code);
+        goto fail;
+    }
+
+fail:
+    /* Delete the gs instance. */
+    gsapi_delete_instance(instance);
+
+failearly:
+    free(pagelist);
+    td->code = code;
+
+#ifdef WINDOWS
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+/* Collect the output from the page count instance so we can
+ * find the "has N pages" line in it. */
+typedef struct
+{
+    char buf[4096];
+    int len;
+} capture_t;
+
+static int GSDLLCALL
+capture_out(void *handle, const char *str, int len)
+{
+    capture_t *cap = (capture_t *)handle;
+    int n = len;
+
+    if (n > (int)sizeof(cap->buf) - 1 - cap->len)
+        n = (int)sizeof(cap->buf) - 1 - cap->len;
+    memcpy(cap->buf + cap->len, str, n);
+    cap->len += n;
+    cap->buf[cap->len] = 0;
+
+    return len;
+}
+
+/* Find the number of pages in the file, using -dPDFINFO. */
+static int
+count_pages(char *in_file)
+{
+    int code;
+    void *instance = NULL;
+    capture_t cap;
+    char *p;
+    int num_pages = -1;
+    int argc = 0;
+    char *argv[10];
+
+    argv[argc++] = "gpdl";
+    argv[argc++] = "-q";
+    argv[argc++] = "-dNODISPLAY";
+    argv[argc++] = "-dPDFINFO";
+    argv[argc++] = "-dFirstPage=1";
+    argv[argc++] = "-dLastPage=1";
+    argv[argc++] = in_file;
+
+    cap.len = 0;
+    cap.buf[0] = 0;
+
+    code = gsapi_new_instance(&instance, &cap);
+    if (code < 0)
+        return code;
+    code = gsapi_set_stdio_with_handle(instance, NULL, capture_out, capture_out, &cap);
+    if (code >= 0)
+        code = gsapi_init_with_args(instance, argc, argv);
+    if (code >= 0)
+        code = gsapi_exit(instance);
+    gsapi_delete_instance(instance);
+    if (code < 0)
+        return code;
+
+    p = strstr(cap.buf, " has ");
+    if (p != NULL)
+        num_pages = atoi(p + 5);
+
+    return num_pages;
+}
+
+/* Move the output files from each worker into their final,
+ * document ordered, places. */
+static int
+collate_outputs(thread_data *td, int num_workers, int num_pages, char *out_template)
+{
+    char tmpl[1024], from[1024], to[1024];
+    int page, failed = 0;
+
+    for (page = 1; page <= num_pages; page++)
+    {
+        int w = (page - 1) % num_workers;
+        int n = (page - 1) / num_workers + 1;
+
+        /* Don't move the output of failed workers. */
+        if (td[w].code != 0)
+            continue;
+        worker_template(tmpl, sizeof(tmpl), out_template, w);
+        snprintf(from, sizeof(from), tmpl, n);
+        snprintf(to, sizeof(to), out_template, page);
+        if (rename(from, to) != 0) {
+            fprintf(stderr, "Failed to rename %s to %s\n", from, to);
+            failed = 1;
+        }
+    }
+
+    return failed;
+}
+
+int main(int argc, char *argv[])
+{
+    int failed = 0;
+#ifndef WINDOWS
+    int code;
+#endif
+    int i, num_workers, num_pages;
+    thread_data td[MAX_WORKERS];
+
+    if (argc < 4) {
+        fprintf(stderr, "Usage: page_parallel <N> <input.pdf> <output template> [gs args...]\n");
+        exit(1);
+    }
+    num_workers = atoi(argv[1]);
+    if (num_workers < 1 || num_workers > MAX_WORKERS) {
+        fprintf(stderr, "Number of workers must be between 1 and %d\n", MAX_WORKERS);
+        exit(1);
+    }
+    if (strstr(argv[3], "%") == NULL) {
+        fprintf(stderr, "Output template must contain a %%d\n");
+        exit(1);
+    }
+
+    num_pages = count_pages(argv[2]);
+    if (num_pages <= 0) {
+        fprintf(stderr, "Failed to find the page count of %s\n", argv[2]);
+        exit(1);
+    }
+    /* No point in having idle workers. */
+    if (num_workers > num_pages)
+        num_workers = num_pages;
+
+    /* Start num_workers threads */
+    for (i = 0; i < num_workers; i++)
+    {
+        td[i].thread_num = i;
+        td[i].num_workers = num_workers;
+        td[i].num_pages = num_pages;
+        td[i].in_file = argv[2];
+        td[i].out_template = argv[3];
+        td[i].extra_argc = argc - 4;
+        td[i].extra_argv = argv + 4;
+
+#ifdef WINDOWS
+        td[i].thread = CreateThread(NULL, 0, worker, &td[i], 0, NULL);
+#else
+        code = pthread_create(&td[i].thread, NULL, worker, &td[i]);
+        if (code != 0) {
+            fprintf(stderr, "Thread %d creation failed\n", i);
+            exit(1);
+        }
+#endif
+    }
+
+    /* Wait for them all to finish */
+    for (i = 0; i < num_workers; i++)
+    {
+        void *status = NULL;
+
+#ifdef WINDOWS
+        WaitForSingleObject(td[i].thread, INFINITE);
+#else
+        code = pthread_join(td[i].thread, &status);
+        if (code != 0) {
+            fprintf(stderr, "Thread join %d failed\n", i);
+            exit(1);
+        }
+#endif
+        /* All the threads should return with 0 */
+        if (td[i].code != 0)
+            failed = 1;
+    }
+
+    /* Now put the pages in order. */
+    if (collate_outputs(td, num_workers, num_pages, argv[3]))
+        failed = 1;
+
+    return failed;
+}
@@ -49,6 +49,7 @@
  */
 /*#define PNG_NO_STDIO*/
 #include "png_.h"
+#include "zlib.h"
 
 #include "gdevprn.h"
 #include "gdevmem.h"
@@ -56,6 +57,7 @@
 #include "gscdefs.h"
 #include "gxdownscale.h"
 #include "gxdevsop.h"
+#include "gxgetbit.h"
 #include "gscms.h"
 
 /* ------ The device descriptors ------ */
@@ -465,6 +467,291 @@ my_png_flush(png_struct *png)
     (void)gp_fflush(file);
 }
 
+/* ------ Band parallel encoding ------ */
+
+/*
+ * When the page is rendered from a clist with rendering threads, the
+ * serial filter/deflate in png_write_rows can take as long as the
+ * rendering itself. Instead, we let each rendering thread filter and
+ * deflate its own band (via the process_page mechanism) into a raw
+ * deflate fragment, ending in a sync flush, so that the fragments can
+ * simply be concatenated. Each fragment is written as its own IDAT,
+ * in band order, on the calling thread. The adler32 of the whole
+ * stream is assembled from the per band checksums.
+ *
+ * Rows are filtered as libpng would (adaptive, minimum sum of absolute
+ * differences) except that the first row of each band can't see the
+ * row above, so only None or Sub are considered there.
+ */
+
+typedef struct png_band_arg_s {
+    png_struct *png_ptr;
+    int rowbytes;		/* bytes per row, excluding the filter byte */
+    int bpp;			/* filter distance in bytes */
+    int height;
+    bool filter;
+    bool invert_alpha;
+    bool invert_mono;
+    int end;			/* mask for the padding bits of the last byte */
+    int mask;
+    bool started;
+    uLong adler;
+} png_band_arg_t;
+
+typedef struct png_band_buffer_s {
+    int size;
+    int compressed;
+    uLong adler;
+    uLong length;		/* uncompressed (filtered) bytes in the band */
+    bool last;
+    byte *prev;			/* previous (unfiltered) row */
+    byte *cur;			/* current (unfiltered) row */
+    byte *filt[5];		/* candidate filtered rows, with filter byte */
+    byte *data;			/* compressed output (raw deflate) */
+} png_band_buffer_t;
+
+static int
+png_band_init_buffer(void *arg_, gx_device *dev, gs_memory_t *mem, int w, int h, void **pbuffer)
+{
+    png_band_arg_t *arg = (png_band_arg_t *)arg_;
+    int rb = arg->rowbytes;
+    int size = deflateBound(NULL, (uLong)(rb + 1) * h) + 16;	/* + sync flush */
+    png_band_buffer_t *buffer;
+    byte *p;
+    int i;
+
+    /* Leave room for the zlib header in front of the compressed data,
+     * and for the adler32 trailer after it. */
+    buffer = (png_band_buffer_t *)gs_alloc_bytes(mem, sizeof(*buffer) + 2 * rb + 5 * (rb + 1) + 2 + size + 4,
+                                                 "png_band_init_buffer");
+    *pbuffer = buffer;
+    if (buffer == NULL)
+        return_error(gs_error_VMerror);
+    p = (byte *)(buffer + 1);
+    buffer->prev = p;
+    p += rb;
+    buffer->cur = p;
+    p += rb;
+    for (i = 0; i < 5; i++) {
+        buffer->filt[i] = p;
+        p += rb + 1;
+    }
+    buffer->data = p + 2;
+    buffer->size = size;
+    buffer->compressed = 0;
+    return 0;
+}
+
+static void
+png_band_free_buffer(void *arg, gx_device *dev, gs_memory_t *mem, void *buffer)
+{
+    gs_free_object(mem, buffer, "png_band_init_buffer");
+}
+
+static void *
+png_band_zalloc(void *mem_, unsigned int items, unsigned int size)
+{
+    gs_memory_t *mem = (gs_memory_t *)mem_;
+
+    return gs_alloc_bytes(mem, items * size, "png_band_zalloc");
+}
+
+static void
+png_band_zfree(void *mem_, void *address)
+{
+    gs_memory_t *mem = (gs_memory_t *)mem_;
+
+    gs_free_object(mem, address, "png_band_zfree");
+}
+
+static inline int
+png_band_paeth(int a, int b, int c)
+{
+    int p = b - c, q = a - c;
+    int pa = p < 0 ? -p : p;
+    int pb = q < 0 ? -q : q;
+    int pc = p + q < 0 ? -(p + q) : p + q;
+
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c;
+}
+
+/* Residuals are summed as signed bytes. */
+#define PNG_BAND_ABS(v) ((v) < 128 ? (v) : 256 - (v))
+
+/* Filter one row, returning the chosen (filter byte prefixed) row.
+ * Each candidate gives up as soon as it can't beat the best so far. */
+static byte *
+png_band_filter_row(const png_band_arg_t *arg, png_band_buffer_t *buffer, bool have_prev)
+{
+    const byte *row = buffer->cur;
+    const byte *up = buffer->prev;
+    int rb = arg->rowbytes, bpp = arg->bpp;
+    int i, f, best = 0;
+    uint sum, best_sum = 0;
+    byte *out;
+
+    if (arg->filter)
+        for (i = 0; i < rb; i++)
+            best_sum += PNG_BAND_ABS(row[i]);
+    for (f = 1; f < (have_prev ? 5 : 2) && arg->filter; f++) {
+        out = buffer->filt[f] + 1;
+        sum = 0;
+        switch (f) {
+            case 1:		/* Sub */
+                for (i = 0; i < bpp; i++) {
+                    out[i] = row[i];
+                    sum += PNG_BAND_ABS(out[i]);
+                }
+                for (; i < rb && sum < best_sum; i++) {
+                    out[i] = row[i] - row[i - bpp];
+                    sum += PNG_BAND_ABS(out[i]);
+                }
+                break;
+            case 2:		/* Up */
+                for (i = 0; i < rb && sum < best_sum; i++) {
+                    out[i] = row[i] - up[i];
+                    sum += PNG_BAND_ABS(out[i]);
+                }
+                break;
+            case 3:		/* Average */
+                for (i = 0; i < bpp; i++) {
+                    out[i] = row[i] - (up[i] >> 1);
+                    sum += PNG_BAND_ABS(out[i]);
+                }
+                for (; i < rb && sum < best_sum; i++) {
+                    out[i] = row[i] - ((row[i - bpp] + up[i]) >> 1);
+                    sum += PNG_BAND_ABS(out[i]);
+                }
+                break;
+            case 4:		/* Paeth */
+                for (i = 0; i < bpp; i++) {
+                    out[i] = row[i] - up[i];
+                    sum += PNG_BAND_ABS(out[i]);
+                }
+                for (; i < rb && sum < best_sum; i++) {
+                    out[i] = row[i] - png_band_paeth(row[i - bpp], up[i], up[i - bpp]);
+                    sum += PNG_BAND_ABS(out[i]);
+                }
+                break;
+        }
+        if (i == rb && sum < best_sum) {
+            best_sum = sum;
+            best = f;
+        }
+    }
+    if (best == 0)
+        memcpy(buffer->filt[0] + 1, row, rb);
+    buffer->filt[best][0] = best;
+    return buffer->filt[best];
+}
+
+static int
+png_band_process(void *arg_, gx_device *dev, gx_device *bdev, const gs_int_rect *rect, void *buffer_)
+{
+    png_band_arg_t *arg = (png_band_arg_t *)arg_;
+    png_band_buffer_t *buffer = (png_band_buffer_t *)buffer_;
+    int rb = arg->rowbytes;
+    int h = rect->q.y - rect->p.y;
+    gs_get_bits_params_t params;
+    gs_int_rect my_rect;
+    z_stream stream;
+    const byte *src;
+    byte *out, *t;
+    int code, err, i, y;
+    uint raster;
+
+    buffer->compressed = 0;
+    buffer->length = 0;
+    buffer->adler = adler32(0, NULL, 0);
+    buffer->last = (rect->q.y >= arg->height);
+    if (h <= 0)
+        return 0;
+
+    params.options = GB_COLORS_NATIVE | GB_ALPHA_NONE | GB_PACKING_CHUNKY |
+                     GB_RETURN_POINTER | GB_ALIGN_ANY | GB_OFFSET_0 |
+                     GB_RASTER_ANY;
+    my_rect.p.x = 0;
+    my_rect.p.y = 0;
+    my_rect.q.x = rect->q.x - rect->p.x;
+    my_rect.q.y = h;
+    code = dev_proc(bdev, get_bits_rectangle)(bdev, &my_rect, &params);
+    if (code < 0)
+        return code;
+
+    stream.zalloc = png_band_zalloc;
+    stream.zfree = png_band_zfree;
+    stream.opaque = bdev->memory;
+    err = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8,
+                       arg->filter ? Z_FILTERED : Z_DEFAULT_STRATEGY);
+    if (err != Z_OK)
+        return_error(gs_error_VMerror);
+    stream.next_out = buffer->data;
+    stream.avail_out = buffer->size;
+
+    src = params.data[0];
+    raster = gx_device_raster(bdev, true);
+    for (y = 0; y < h; y++, src += raster) {
+        /* Apply the transforms that libpng would have done for us.
+         * 16 bit samples are already big endian, as PNG wants them. */
+        memcpy(buffer->cur, src, rb);
+        if (arg->invert_alpha)
+            for (i = 3; i < rb; i += 4)
+                buffer->cur[i] ^= 0xff;
+        if (arg->invert_mono)
+            for (i = 0; i < rb; i++)
+                buffer->cur[i] ^= 0xff;
+        /* Keep the output independent of whatever is in the padding. */
+        buffer->cur[arg->end] &= arg->mask;
+        out = png_band_filter_row(arg, buffer, y > 0);
+        buffer->adler = adler32(buffer->adler, out, rb + 1);
+        buffer->length += rb + 1;
+        stream.next_in = out;
+        stream.avail_in = rb + 1;
+        err = deflate(&stream, y < h - 1 ? Z_NO_FLUSH :
+                               buffer->last ? Z_FINISH : Z_SYNC_FLUSH);
+        if (err != Z_OK && err != Z_STREAM_END)
+            break;
+        t = buffer->prev;
+        buffer->prev = buffer->cur;
+        buffer->cur = t;
+    }
+    buffer->compressed = buffer->size - stream.avail_out;
+    (void)deflateEnd(&stream);
+    if (y < h)
+        return_error(gs_error_VMerror);
+
+    return 0;
+}
+
+static int
+png_band_output(void *arg_, gx_device *dev, void *buffer_)
+{
+    png_band_arg_t *arg = (png_band_arg_t *)arg_;
+    png_band_buffer_t *buffer = (png_band_buffer_t *)buffer_;
+    byte *data = buffer->data;
+    int len = buffer->compressed;
+
+    if (buffer->length == 0)
+        return 0;
+    if (!arg->started) {
+        /* 32K window, default compression level. */
+        *--data = 0x9c;
+        *--data = 0x78;
+        len += 2;
+        arg->adler = buffer->adler;
+        arg->started = true;
+    } else
+        arg->adler = adler32_combine(arg->adler, buffer->adler, (z_off_t)buffer->length);
+    if (buffer->last) {
+        data[len++] = (byte)(arg->adler >> 24);
+        data[len++] = (byte)(arg->adler >> 16);
+        data[len++] = (byte)(arg->adler >> 8);
+        data[len++] = (byte)arg->adler;
+    }
+    png_write_chunk(arg->png_ptr, (png_const_bytep)"IDAT", data, len);
+    return 0;
+}
+
 /* Write out a page in PNG format. */
 /* This routine is used for all formats. */
 static int
@@ -749,6 +1036,41 @@ do_png_print_page(gx_device_png * pdev, gp_file * file, bool monod)
     info_ptr->text = NULL;
 #endif
 
+    /* If the page is being rendered by several threads, and there is
+     * no downscaling to do, have the rendering threads compress the
+     * bands too (see png_band_process above). */
+    if (!monod && PRINTER_IS_CLIST(pdev) &&
+        pdev->num_render_threads_requested > 1 &&
+        upfactor == 1 && downfactor == 1 && src_bpc == dst_bpc &&
+        pdev->downscale.min_feature_size <= 1 &&
+        pdev->downscale.trap_w == 0 && pdev->downscale.trap_h == 0 &&
+        pdev->downscale.ets == 0) {
+        gx_process_page_options_t process = { 0 };
+        png_band_arg_t arg;
+
+        memset(&arg, 0, sizeof(arg));
+        arg.png_ptr = png_ptr;
+        arg.rowbytes = (width * depth + 7) >> 3;
+        arg.bpp = (depth + 7) >> 3;
+        arg.height = height;
+        arg.filter = (bit_depth >= 8 && color_type != PNG_COLOR_TYPE_PALETTE);
+        arg.invert_alpha = invert && depth == 32;
+        arg.invert_mono = invert && depth != 32;
+        arg.end = arg.rowbytes - 1;
+        arg.mask = 0xff;
+        if ((width * depth) & 7)
+            arg.mask = ~(0xff >> ((width * depth) & 7)) & 0xff;
+        process.init_buffer_fn = png_band_init_buffer;
+        process.free_buffer_fn = png_band_free_buffer;
+        process.process_fn = png_band_process;
+        process.output_fn = png_band_output;
+        process.arg = &arg;
+        code = dev_proc(pdev, process_page)((gx_device *)pdev, &process);
+        if (code >= 0)
+            png_write_chunk(png_ptr, (png_const_bytep)"IEND", NULL, 0);
+        goto finished;
+    }
+
     /* For simplicity of code, we always go through the downscaler. For
      * non-supported depths, it will pass through with minimal performance
      * hit. So ensure that we only trigger downscales when we need them.
@@ -780,6 +1102,7 @@ do_png_print_page(gx_device_png * pdev, gp_file * file, bool monod)
     /* write the rest of the file */
     png_write_end(png_ptr, info_ptr);
 
+  finished:
 #if PNG_LIBPNG_VER_MINOR >= 5
 #else
     /* if you alloced the palette, free it here */